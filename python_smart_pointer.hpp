@@ -0,0 +1,115 @@
+#ifndef __PYTHON_SMART_POINTER_HPP__
+#define __PYTHON_SMART_POINTER_HPP__
+
+#include <Python.h>
+#include <string>
+
+/********************************************************** python smart pointer **********************************************************/
+
+class PythonSmartPointer{
+private:
+    mutable PyObject* _py_object;
+    mutable std::string _obj_string;
+public:
+
+    PythonSmartPointer()
+    :_py_object(NULL)
+    { }
+
+    PythonSmartPointer(PyObject* py_object)
+    :_py_object(py_object){
+        Py_XINCREF(_py_object);
+    }
+
+    PythonSmartPointer(const PythonSmartPointer& copy)
+    :_py_object(copy._py_object){
+        Py_XINCREF(_py_object);
+    }
+
+    PythonSmartPointer(PythonSmartPointer&& other) noexcept
+    :_py_object(other._py_object){
+        other._py_object = NULL;
+    }
+
+    PythonSmartPointer& operator=(const PythonSmartPointer& rhs){
+
+        Py_XINCREF(rhs._py_object);
+        Py_XDECREF(_py_object);
+        _py_object = rhs._py_object;
+        return *this;
+    }
+
+    PythonSmartPointer& operator=(PythonSmartPointer&& rhs) noexcept{
+
+        if(this != &rhs){
+            Py_XDECREF(_py_object);
+            _py_object = rhs._py_object;
+            rhs._py_object = NULL;
+        }
+        return *this;
+    }
+
+    PythonSmartPointer& operator=(PyObject* rhs){
+
+        Py_XINCREF(rhs);
+        Py_XDECREF(_py_object);
+        _py_object = rhs;
+        return *this;
+    }
+
+    bool operator==(const PythonSmartPointer& other)const{
+        
+        if(!_py_object)
+            return false;
+
+        return PyObject_RichCompareBool(_py_object, other._py_object, Py_EQ);
+    }
+
+    bool operator!=(const PythonSmartPointer& other)const{
+
+        if(!_py_object)
+            return true;
+
+        return PyObject_RichCompareBool(_py_object, other._py_object, Py_NE);
+    }
+
+    operator PyObject*() const{
+        return _py_object;
+    }
+
+    PyObject* increase_ref() const{
+        
+        Py_INCREF(_py_object);
+        return _py_object;
+
+    }
+
+    operator std::string()const{
+        PyObject* objects_representation = PyObject_Str(_py_object);
+
+        if(!objects_representation)
+            return "";
+
+        const char* s = PyUnicode_AsUTF8(objects_representation);
+
+        if(!s)
+             _obj_string = "";
+        else
+            _obj_string = s;
+
+        Py_DECREF(objects_representation);
+
+        return _obj_string.c_str();
+
+    }
+
+    ~PythonSmartPointer(){
+        if(_py_object)
+            Py_XDECREF(_py_object);
+    }
+
+};
+
+/********************************************************** python smart pointer **********************************************************/
+
+#endif //__PYTHON_SMART_POINTER_HPP__
@@ -57,6 +57,96 @@ print(f'randomizer has {len(randomizer)} elements')
 for key, value in counter.items():
     print(f'{key}:{value}')
 
+counter = {}
+
+print(f'---rolling many on 4 threads---')
+for value in randomizer.roll_many(100000, 4):
+
+    if value not in counter:
+        counter[value] = 1
+    else:
+        counter[value] += 1
+
+for key, value in counter.items():
+    print(f'{key}:{value}')
+
+counter = {}
+excluded = [to_update]
+
+print(f'---rolling with {excluded} excluded---')
+excluded_indices = [randomizer.index(key) for key in excluded]
+for i in range(10000):
+
+    value = randomizer.roll_excluding_indices(excluded_indices)
+
+    if value not in counter:
+        counter[value] = 1
+    else:
+        counter[value] += 1
+
+for key, value in counter.items():
+    print(f'{key}:{value}')
+
+bank = roulette.roulette_bank([initial_list, additional_insert])
+
+print(f'---rolling bank rows---')
+for row in range(2):
+    counter = {}
+
+    for value in bank.roll_rows([row] * 10000):
+
+        if value not in counter:
+            counter[value] = 1
+        else:
+            counter[value] += 1
+
+    for key, value in counter.items():
+        print(f'row {row} {key}:{value}')
+
+experiment = roulette.roulette([('control', 1), ('variant a', 1), ('variant b', 2)])
+
+print(f'---keyed rolls, the same as in roulette_test.cpp---')
+for key in ['user 1', 'user 2', 'user 3', 'user 4', 'user 5']:
+    first = experiment.roll_for(key)
+    again = experiment.roll_for(key)
+    print(f'{key} is assigned {first}' + ('' if first == again else ' but not on the second roll'))
+
+counter = {}
+for value in experiment.roll_for_many(list(range(10000))):
+
+    if value not in counter:
+        counter[value] = 1
+    else:
+        counter[value] += 1
+
+for key, value in counter.items():
+    print(f'{key}:{value}')
+
+if hasattr(roulette, 'publish_shared'):
+    roulette.publish_shared('python_test', [('shared first', 3), ('shared second', 1)])
+    shared = roulette.shared_roulette('python_test')
+
+    for republish in (False, True):
+        if republish:
+            roulette.publish_shared('python_test', [('shared first', 1), ('shared republished', 1)])
+
+        counter = {}
+
+        for i in range(10000):
+
+            value = shared.roll()
+
+            if value not in counter:
+                counter[value] = 1
+            else:
+                counter[value] += 1
+
+        print(f'---shared generation {shared.generation}---')
+        for key, value in counter.items():
+            print(f'{key}:{value}')
+
+    roulette.unlink_shared('python_test')
+
 iter = iter(randomizer)
 
 print(f'iter type = {type(iter)}')
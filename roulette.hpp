@@ -4,6 +4,8 @@
 
 #include <stdexcept>
 #include <vector>
+#include <array>
+#include <algorithm>
 #include <ctime>
 #include <cstdlib>
 #include <sstream>
@@ -12,6 +14,26 @@
 #include <utility>
 #include <random>
 #include <chrono>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <cmath>
+#include <new>
+#include <memory>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <string>
+#include <functional>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <sched.h>
+#endif
 
 #ifdef ROULETTE_DEBUG_PYTHON
 #include <Python.h>
@@ -31,9 +53,176 @@
 
 #endif
 
+/* splitmix64 finalizer, a bijection that spreads every input bit over the whole word */
+inline uint64_t mix64(uint64_t z){
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* one splitmix64 step, used to spread a single seed over a whole engine state */
+inline uint64_t splitmix64(uint64_t& state){
+    return mix64(state += 0x9E3779B97F4A7C15ULL);
+}
+
+/*
+    hashes behind Roulette::roll_for, a key maps to the same word on every platform and run:
+    integers (two's complement, so -1 and 2^64-1 collide) through mix64, byte strings through fnv-1a then mix64
+*/
+inline uint64_t roulette_key_hash(const void* data, size_t length){
+
+    unsigned char const* bytes = (unsigned char const*)data;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for(size_t i = 0 ; i < length ; ++i)
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+
+    return mix64(hash);
+}
+
+inline uint64_t roulette_key_hash(std::string const& key){
+    return roulette_key_hash(key.data(), key.size());
+}
+
+inline uint64_t roulette_key_hash(const char* key){
+    return roulette_key_hash(key, strlen(key));
+}
+
+template<typename KEY>
+uint64_t roulette_key_hash(KEY const& key){
+
+    if constexpr (std::is_integral<KEY>::value || std::is_enum<KEY>::value)
+        return mix64((uint64_t)key);
+    else
+        return mix64((uint64_t)std::hash<KEY>()(key));  //only as stable as the standard library hash
+}
+
+/* xoshiro256** engine, 32 bytes of state and full 64 bit output words */
+class Xoshiro256{
+private:
+    uint64_t _state[4];
+
+    static uint64_t rotl(uint64_t x, int k){
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    typedef uint64_t result_type;
+
+    static constexpr result_type min(){ return 0; }
+    static constexpr result_type max(){ return std::numeric_limits<result_type>::max(); }
+
+    explicit Xoshiro256(uint64_t seed = 0){
+        for(int i = 0 ; i < 4 ; ++i)
+            _state[i] = splitmix64(seed);
+    }
+
+    result_type operator()(){
+        const uint64_t result = rotl(_state[1] * 5, 7) * 9;
+        const uint64_t t = _state[1] << 17;
+
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+
+        _state[2] ^= t;
+        _state[3] = rotl(_state[3], 45);
+
+        return result;
+    }
+
+    /* advances the state by 2^128 draws, streams jumped apart this way never overlap in practice */
+    void jump(){
+        static const uint64_t jump_words[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+        uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+        for(uint64_t word : jump_words){
+            for(int b = 0 ; b < 64 ; ++b){
+                if(word & (1ULL << b)){
+                    s0 ^= _state[0];
+                    s1 ^= _state[1];
+                    s2 ^= _state[2];
+                    s3 ^= _state[3];
+                }
+
+                (*this)();
+            }
+        }
+
+        _state[0] = s0;
+        _state[1] = s1;
+        _state[2] = s2;
+        _state[3] = s3;
+    }
+};
+
+/* unbiased integer in [0, bound) using Lemire's multiply and reject method, next_word() must return full 64 bit words */
+template<typename WORD_GEN>
+uint64_t lemire_bounded(WORD_GEN& next_word, uint64_t bound){
+
+    if(bound == 0)
+        throw std::invalid_argument("bound cannot be 0");
+
+    if(bound <= 0xFFFFFFFFULL){
+        const uint32_t s = (uint32_t)bound;
+        uint64_t m = (uint64_t)(uint32_t)(next_word() >> 32) * s;
+        uint32_t l = (uint32_t)m;
+
+        if(l < s){
+            const uint32_t t = (0u - s) % s;
+
+            while(l < t){
+                m = (uint64_t)(uint32_t)(next_word() >> 32) * s;
+                l = (uint32_t)m;
+            }
+        }
+
+        return m >> 32;
+    }
+
+#ifdef __SIZEOF_INT128__
+    __uint128_t m = (__uint128_t)next_word() * bound;
+    uint64_t l = (uint64_t)m;
+
+    if(l < bound){
+        const uint64_t t = (0 - bound) % bound;
+
+        while(l < t){
+            m = (__uint128_t)next_word() * bound;
+            l = (uint64_t)m;
+        }
+    }
+
+    return (uint64_t)(m >> 64);
+#else
+    const uint64_t t = (0 - bound) % bound;
+    uint64_t x;
+
+    do{
+        x = next_word();
+    }while(x < t);
+
+    return x % bound;
+#endif
+}
+
 class SimpleRand{
     private:
-    static bool _is_init;
+    static inline bool _is_init = false;
+
+    /* rand() only promises 15 bits per call */
+    struct word_gen{
+        uint64_t operator()()const{
+            uint64_t word = 0;
+
+            for(int i = 0 ; i < 5 ; ++i)
+                word = (word << 15) | (uint64_t)(rand() & 0x7FFF);
+
+            return word;
+        }
+    };
+
     public:
         SimpleRand(){
             if(!_is_init){
@@ -50,260 +239,2197 @@ class SimpleRand{
             return (max - min)*(rand()/((double)RAND_MAX+1)) + min;
 
         }
+
+        uint64_t operator()(uint64_t bound)const{
+            word_gen next_word;
+            return lemire_bounded(next_word, bound);
+        }
 };
 
 class NewRand{
 
     private:
-    mutable std::default_random_engine _rando_seeder;  //Will be used to obtain a seed for the random number engine
-    ///std::mt19937 _generator; //Standard mersenne_twister_engine seeded with rd()
+    mutable Xoshiro256 _engine;  //seeded from the clock, also feeds the integer draws
     mutable std::uniform_real_distribution<> _distribution;
 
     public:
 
         NewRand()
-        :_rando_seeder((unsigned int)std::chrono::system_clock::now().time_since_epoch().count())
+        :_engine((uint64_t)std::chrono::system_clock::now().time_since_epoch().count())
+        ,_distribution(0.0,1.0)
+        { }
+
+        explicit NewRand(uint64_t seed)
+        :_engine(seed)
         ,_distribution(0.0,1.0)
         { }
 
+        /* moves to a stream 2^128 draws ahead, see Xoshiro256::jump */
+        void jump(){
+            _engine.jump();
+            _distribution.reset();
+        }
+
         double operator()(double min,double max)const {
 
             if(min >= max)
                 throw std::invalid_argument("min cannot be greater or equal to max");
 
-            return (max - min)* _distribution(_rando_seeder) + min;
+            return (max - min)* _distribution(_engine) + min;
+        }
+
+        uint64_t operator()(uint64_t bound)const {
+            return lemire_bounded(_engine, bound);
         }
 };
 
-bool SimpleRand::_is_init = false;
+/* how a roulette of weight type W draws a point in [0, total) */
+template<typename W, bool IS_INTEGRAL = std::is_integral<W>::value>
+struct WeightTraits{
+    static_assert(std::is_floating_point<W>::value, "weight type must be a floating point or an unsigned integral type");
+
+    template<typename ROLLER>
+    static W draw(const ROLLER& rand_gen, W total){
+        return (W)rand_gen(0.0, (double)total);
+    }
+
+    /* point in [0, total) picked by a 64 bit word, the word's top 53 bits become the fraction */
+    static W point(uint64_t word, W total){
+        W point = (W)((word >> 11) * (1.0 / 9007199254740992.0) * (double)total);
+        return (point < total)? point : std::nextafter(total, W(0));
+    }
+};
+
+template<typename W>
+struct WeightTraits<W, true>{
+    static_assert(std::is_unsigned<W>::value, "integral weight type must be unsigned");
+
+    template<typename ROLLER>
+    static W draw(const ROLLER& rand_gen, W total){
+        return (W)rand_gen((uint64_t)total);
+    }
+
+    /* point in [0, total) picked by a 64 bit word, high half of word * total */
+    static W point(uint64_t word, W total){
+#ifdef __SIZEOF_INT128__
+        return (W)(((__uint128_t)word * (uint64_t)total) >> 64);
+#else
+        return (W)((word >> 11) * (1.0 / 9007199254740992.0) * (double)total);
+#endif
+    }
+};
+
+/* huge page backed blocks for very large tables, blocks smaller than a huge page (or off linux) come from the heap */
+struct HugePageMemory{
+
+    static const size_t huge_page_size = 2 * 1024 * 1024;
+
+    static bool is_mapped(size_t bytes){
+#if defined(__linux__)
+        return bytes >= huge_page_size;
+#else
+        (void)bytes;
+        return false;
+#endif
+    }
+
+    static size_t mapped_size(size_t bytes){
+        return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+    }
+
+    /* node >= 0 binds the pages to that numa node before they are first touched */
+    static void* allocate(size_t bytes, int node = -1){
+
+        if(!is_mapped(bytes))
+            return ::operator new(bytes);
+
+#if defined(__linux__)
+        size_t size = mapped_size(bytes);
+
+        //over map by one huge page so the block can start on a huge page boundary
+        char* raw = (char*)mmap(NULL, size + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if(raw == (char*)MAP_FAILED)
+            throw std::bad_alloc();
+
+        char* aligned = (char*)(((uintptr_t)raw + huge_page_size - 1) & ~(uintptr_t)(huge_page_size - 1));
+
+        if(aligned != raw)
+            munmap(raw, aligned - raw);
+
+        if(raw + huge_page_size != aligned)
+            munmap(aligned + size, (raw + huge_page_size) - aligned);
+
+#ifdef MADV_HUGEPAGE
+        madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+
+#ifdef SYS_mbind
+        if(node >= 0){
+            const unsigned long bits = 8 * sizeof(unsigned long);
+            std::vector<unsigned long> mask(node / bits + 1, 0);
+            mask[node / bits] = 1UL << (node % bits);
+            const int mpol_bind = 2;
+
+            //best effort, without numa support the pages just stay where the kernel puts them
+            syscall(SYS_mbind, aligned, size, mpol_bind, mask.data(), mask.size() * bits + 1, 0);
+        }
+#endif
+        (void)node;
+        return aligned;
+#else
+        (void)node;
+        return ::operator new(bytes);
+#endif
+    }
+
+    static void deallocate(void* ptr, size_t bytes){
+
+        if(!ptr)
+            return;
+
+        if(!is_mapped(bytes)){
+            ::operator delete(ptr);
+            return;
+        }
+
+#if defined(__linux__)
+        munmap(ptr, mapped_size(bytes));
+#endif
+    }
+};
+
+/* stateless allocator over HugePageMemory, meant as the ALLOC argument of Roulette */
+template<typename U>
+class HugePageAllocator{
+public:
+    typedef U value_type;
+
+    HugePageAllocator(){}
+
+    template<typename V>
+    HugePageAllocator(const HugePageAllocator<V>&){}
+
+    U* allocate(size_t n){
+        return (U*)HugePageMemory::allocate(n * sizeof(U));
+    }
+
+    void deallocate(U* ptr, size_t n){
+        HugePageMemory::deallocate(ptr, n * sizeof(U));
+    }
+
+    template<typename V>
+    bool operator==(const HugePageAllocator<V>&)const{ return true; }
+
+    template<typename V>
+    bool operator!=(const HugePageAllocator<V>&)const{ return false; }
+};
+
+/* number of numa nodes the kernel may report, 1 when unknown */
+inline size_t numa_node_count(){
+
+    static const size_t count = [](){
+        size_t nodes_count = 1;
+
+#if defined(__linux__)
+        std::ifstream possible("/sys/devices/system/node/possible");
+        std::string nodes;
+
+        //the file holds a range list such as "0" or "0-1", the last number is the highest node
+        if(possible >> nodes){
+            size_t last = nodes.find_last_of(",-");
+            nodes_count = (size_t)std::strtoul(nodes.c_str() + (last == std::string::npos ? 0 : last + 1), NULL, 10) + 1;
+        }
+#endif
+
+        return nodes_count;
+    }();
+
+    return count;
+}
+
+/* numa node of every cpu read once from sysfs, empty on single node machines or when unknown */
+inline std::vector<size_t> const& numa_node_of_cpu(){
+
+    static const std::vector<size_t> nodes = [](){
+        std::vector<size_t> node_of_cpu;
+
+#if defined(__linux__)
+        for(size_t node = 0 ; numa_node_count() > 1 && node < numa_node_count() ; ++node){
+            std::ifstream cpu_list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            std::string ranges, range;
+
+            if(!(cpu_list >> ranges))
+                continue;
+
+            //a range list such as "0-3,8-11"
+            std::istringstream ranges_stream(ranges);
+
+            while(std::getline(ranges_stream, range, ',')){
+                size_t dash = range.find('-');
+                size_t first = std::strtoul(range.c_str(), NULL, 10);
+                size_t last = (dash == std::string::npos)? first : std::strtoul(range.c_str() + dash + 1, NULL, 10);
+
+                if(node_of_cpu.size() <= last)
+                    node_of_cpu.resize(last + 1, 0);
+
+                for(size_t cpu = first ; cpu <= last ; ++cpu)
+                    node_of_cpu[cpu] = node;
+            }
+        }
+#endif
+
+        return node_of_cpu;
+    }();
+
+    return nodes;
+}
+
+/* numa node of the cpu running the calling thread, 0 when unknown. sched_getcpu() goes through the vdso, no syscall */
+inline size_t current_numa_node(){
+
+#if defined(__linux__)
+    std::vector<size_t> const& node_of_cpu = numa_node_of_cpu();
+
+    if(node_of_cpu.empty())
+        return 0;
+
+    int cpu = sched_getcpu();
+
+    if(cpu >= 0 && (size_t)cpu < node_of_cpu.size())
+        return node_of_cpu[cpu];
+#endif
+
+    return 0;
+}
+
+/* one copy of a read-only array per numa node, each placed on its own node */
+template<typename U>
+class NumaReplicas{
+private:
+    std::vector<U*> _copies;
+    size_t _count;
+
+public:
+    NumaReplicas()
+    :_count(0)
+    {}
+
+    NumaReplicas(const NumaReplicas&) = delete;
+    NumaReplicas& operator=(const NumaReplicas&) = delete;
+
+    ~NumaReplicas(){
+        clear();
+    }
+
+    /* copies count items produced by source(i) onto every node */
+    template<typename SOURCE>
+    void build(SOURCE source, size_t count){
 
-template<typename T>
+        clear();
+
+        if(!count)
+            return;
+
+        size_t nodes = numa_node_count();
+
+        try{
+            for(size_t node = 0 ; node < nodes ; ++node){
+                U* copy = (U*)HugePageMemory::allocate(count * sizeof(U), (int)node);
+                _copies.push_back(copy);
+
+                for(size_t i = 0 ; i < count ; ++i)
+                    copy[i] = source(i);
+            }
+        }catch(...){
+            _count = count;
+            clear();
+            throw;
+        }
+
+        _count = count;
+    }
+
+    void clear(){
+        for(U* copy : _copies)
+            HugePageMemory::deallocate(copy, _count * sizeof(U));
+
+        _copies.clear();
+        _count = 0;
+    }
+
+    bool is_ready()const{
+        return !_copies.empty();
+    }
+
+    size_t size()const{
+        return _count;
+    }
+
+    /* the copy on the node of the calling thread */
+    U const* local()const{
+        size_t node = current_numa_node();
+        return _copies[node < _copies.size() ? node : 0];
+    }
+};
+
+/* the value owns the range [min, max), only the upper bound and the weight are stored so weights never drift */
+template<typename T, typename W = double>
 class RangedValue{
 private:
-    double _min;
-    double _max;
+    W _max;
+    W _range;
     T _val;
 
 public:
-    RangedValue(double min,double max,T val)
-    :_min(min),_max(max),_val(val){
+    RangedValue(W min,W max,T val)
+    :_max(max),_range(max - min),_val(std::move(val)){
 
         if(min >= max){
             throw std::invalid_argument("min cannot be greater or equal to max");
         }
     }
 
-    RangedValue(RangedValue& other)
-    :_min(other._min),_max(other._max),_val(other._val){
+    /* builds the value in place from args */
+    template<typename... ARGS>
+    RangedValue(W min,W max,std::in_place_t,ARGS&&... args)
+    :_max(max),_range(max - min),_val(std::forward<ARGS>(args)...){
+
+        if(min >= max){
+            throw std::invalid_argument("min cannot be greater or equal to max");
+        }
     }
 
     RangedValue(const RangedValue& other)
-    :_min(other._min),_max(other._max),_val(other._val){
+    :_max(other._max),_range(other._range),_val(other._val){
+    }
+
+    RangedValue(RangedValue&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+    :_max(other._max),_range(other._range),_val(std::move(other._val)){
     }
 
     RangedValue& operator=(const RangedValue& rhs){
-        _min = rhs._min;
         _max = rhs._max;
+        _range = rhs._range;
         _val = rhs._val;
 		
 		return *this;
     }
 
-    virtual ~RangedValue() { }
+    RangedValue& operator=(RangedValue&& rhs) noexcept(std::is_nothrow_move_assignable<T>::value){
+        _max = rhs._max;
+        _range = rhs._range;
+        _val = std::move(rhs._val);
+
+        return *this;
+    }
+
+    ~RangedValue() { }
 
-    void update_offset(double new_offset){
-        _max = new_offset + (_max - _min);
-        _min = new_offset;
+    void update_offset(W new_offset){
+        _max = new_offset + _range;
     }
 
-    void update_range(double new_range ){
-        _max = _min + new_range;
+    void update_range(W new_range ){
+        _max = get_min() + new_range;
+        _range = new_range;
     }
 
-    bool operator<(const double& val)const {
+    bool operator<(const W& val)const {
 
-        if(_max < val)
+        if(_max <= val)
             return true;
 
         return false;
     }
 
-    bool operator>(const double& val)const {
-        if(_min>val)
+    bool operator>(const W& val)const {
+        if(get_min()>val)
             return true;
 
         return false;
     }
 
-    bool operator==(const double& val)const{
+    bool operator==(const W& val)const{
 
-        if(val >= _min && val <= _max)
+        if(val >= get_min() && val < _max)
             return true;
 
         return false;
     }
 
-    virtual double get_min()const{
-        return _min;
+    W get_min()const{
+        return _max - _range;
     }
 
-    virtual double get_max()const{
+    W const& get_max()const{
         return _max;
     }
 
-    virtual double get_range()const{
-        return _max - _min;
+    W const& get_range()const{
+        return _range;
     }
 
-    virtual T& get_value(){
+    T& get_value(){
         return _val;
     }
 
-    virtual T const& get_value()const {
+    T const& get_value()const {
         return _val;
     }
 };
 
-template <typename T, typename ROLLER = NewRand>
-class Roulette{
-public:
-    typedef typename std::vector<RangedValue<T> >::iterator iterator;
+/*
+    search tree over a cumulative table where every node halves the mass of its subtree instead of its entry count,
+    an entry of probability p sits about log2(1/p) levels deep so a roll costs close to the entropy of the weights
+    instead of log2(n) steps. subtrees lighter than a few average entries are left to a plain binary search over
+    their contiguous range, which keeps the tree small enough to stay in cache. nodes are kept in preorder so
+    the heavy top of the tree shares a few cache lines
+*/
+template<typename W>
+class MassBisectionTree{
 private:
-    ROLLER _rand_gen;
-    std::vector<RangedValue<T> > _range_list;
-    double _last_val;
+    static const size_t leaf_entries = 8;   //subtrees holding less mass than this many average entries are not split
+
+    struct node{
+        W low;
+        W high;
+        uint32_t index;
+        uint32_t right;     //0 when there is none, the root is never a child
+        uint32_t first;     //entries covered by the subtree
+        uint32_t last;
+        bool has_left;      //the left child is always the next node
+    };
+
+    struct pending{
+        size_t first;
+        size_t last;
+        size_t parent;
+        bool is_right;
+    };
+
+    std::vector<node> _nodes;
+    size_t _count;
+    size_t _fallback;           //last entry holding any weight, for rolls rounded onto the total
 
-protected:
-    virtual size_t find_index(double roll)const {
+public:
+    MassBisectionTree()
+    :_count(0)
+    ,_fallback(0)
+    {}
 
-        size_t start = 0, fin = _range_list.size()-1,mid;
+    bool is_ready()const{
+        return !_nodes.empty();
+    }
 
-        while(start <= fin){
-            mid = (start+fin)/2;
+    void clear(){
+        _nodes.clear();
+        _nodes.shrink_to_fit();
+    }
 
-            if(_range_list[mid] < roll){
-                start = mid+1;
-                continue;
-            }
+    /* upper(i) is the cumulative upper bound of entry i, O(n log n), tables beyond 2^32 entries are left unindexed */
+    template<typename UPPER>
+    void build(UPPER upper, size_t count){
 
-            if(_range_list[mid] > roll){
-                fin = mid-1;
-                continue;
-            }
+        auto lower = [&](size_t i){ return i ? upper(i - 1) : W(0); };
+        std::vector<pending> stack;
 
-            if(_range_list[mid] == roll){
-                return mid;
-            }
+        clear();
 
-            DBG_FORMAT_LINE("%s", __func__);
-            throw std::logic_error("reached the end of the loop, not possible");
-        }
+        if(!count || count > std::numeric_limits<uint32_t>::max() || !(upper(count - 1) > W(0)))
+            return;
 
-        DBG_FORMAT_LINE("%s", __func__);
-        throw std::logic_error("reached the end of the loop, and not found a value");
-    }
+        const double leaf_mass = (double)upper(count - 1) * leaf_entries / count;
 
-public:
+        _count = count;
 
-    Roulette(ROLLER rand_gen = ROLLER())
-    :_rand_gen(rand_gen)
-    ,_last_val(0)
-    {}
-    
-    Roulette(const std::initializer_list<std::pair<T, double> >& list, ROLLER rand_gen = ROLLER())
-    :_rand_gen(rand_gen)
-    ,_last_val(0)
-    {
-        for(const auto& val : list){
-            double shadow = _last_val;
-            _range_list.push_back(RangedValue<T>(shadow, _last_val+=val.second, val.first));
-        }
-    }
+        for(_fallback = count - 1 ; _fallback > 0 && upper(_fallback) == upper(_fallback - 1) ; --_fallback);
 
-    Roulette(const Roulette& other)
-    :_rand_gen(other._rand_gen)
-    ,_range_list(other._range_list)
-    ,_last_val(other._last_val)
-    {}
+        stack.push_back({0, count, 0, false});
 
-    virtual ~Roulette()
-    {}
+        while(!stack.empty()){
+            pending task = stack.back();
+            stack.pop_back();
 
-    virtual iterator begin(){ return _range_list.begin(); }
-    virtual iterator end(){ return _range_list.end(); }
+            W low = lower(task.first), high = upper(task.last - 1);
 
-    virtual void insert(T val, double chance){
+            //ranges without mass can never be hit, light ones are binary searched from their parent
+            if(!(low < high) || (!_nodes.empty() && (double)(high - low) < leaf_mass))
+                continue;
 
-        if (chance <= 0)
-            std::logic_error("chance cannot be equal or less than 0");
+            W middle = low + (high - low) / 2;
+            size_t start = task.first, fin = task.last;
 
-        double shadow = _last_val;
-        _range_list.push_back(RangedValue<T>(shadow, (_last_val+=chance), val));
-    }
+            //entry owning the middle of the mass, it always holds weight
+            while(start < fin){
+                size_t mid = start + (fin - start) / 2;
 
-    virtual iterator find(T const & value){
-        
-        for (auto iter = _range_list.begin() ; iter != _range_list.end(); ++iter)
-            if(iter->get_value() == value)
-                return iter;
+                if(upper(mid) <= middle)
+                    start = mid + 1;
+                else
+                    fin = mid;
+            }
 
-        return _range_list.end();
-    }
+            size_t id = _nodes.size();
+            _nodes.push_back({lower(start), upper(start), (uint32_t)start, 0, (uint32_t)task.first, (uint32_t)task.last, false});
 
-    virtual bool remove(T const & value){
-        auto iter = find(value);
+            if(id){
+                if(task.is_right)
+                    _nodes[task.parent].right = (uint32_t)id;
+                else
+                    _nodes[task.parent].has_left = true;
+            }
 
-        if (iter == _range_list.end())
-            return false;
+            //left is taken next so it lands right after its parent
+            if(start + 1 < task.last)
+                stack.push_back({start + 1, task.last, id, true});
 
-        auto to_remove_iter = iter;
-        double new_offset = iter->get_min();
+            if(task.first < start)
+                stack.push_back({task.first, start, id, false});
+        }
+    }
 
-        for(++iter; iter != _range_list.end() ; ++iter){
-            iter->update_offset(new_offset);
-            new_offset = iter->get_max();
+    /* entry whose range holds roll, upper() must describe the table the tree was built from */
+    template<typename UPPER>
+    size_t find(W roll, UPPER upper)const{
+
+        size_t current = 0, first, last;
+
+        for(;;){
+            node const& at = _nodes[current];
+
+            if(roll < at.low){
+                if(at.has_left){
+                    ++current;
+                    continue;
+                }
+
+                first = at.first;
+                last = at.index;
+            }else if(roll >= at.high){
+                if(at.right){
+                    current = at.right;
+                    continue;
+                }
+
+                first = at.index + 1;
+                last = at.last;
+            }else{
+                return at.index;
+            }
+
+            break;
         }
 
-        _last_val = new_offset;
+        while(first < last){
+            size_t mid = first + (last - first) / 2;
 
-        _range_list.erase(to_remove_iter);
+            if(upper(mid) <= roll)
+                first = mid + 1;
+            else
+                last = mid;
+        }
 
-        return true;
+        return (first < _count)? first : _fallback;
     }
+};
 
-    virtual bool update(T const& value, double new_value){
-        auto iter = find(value);
+/* how Roulette::resample turns n draws into one ordered sweep over the table */
+enum resample_method{
+    RESAMPLE_MULTINOMIAL,   //n independent draws, generated already sorted through exponential spacings
+    RESAMPLE_SYSTEMATIC,    //one uniform offset, then n evenly spaced points
+    RESAMPLE_STRATIFIED,    //one uniform point inside each of n equal strata
+    RESAMPLE_RESIDUAL       //floor(n * w / total) copies of each entry, the rest drawn multinomially from the residuals
+};
 
-        if (iter == _range_list.end())
-            return false;
+/* forward iterator over the slots of a roulette that skips tombstoned ones, see Roulette::set_lazy_removal */
+template<typename SLOT_ITERATOR>
+class LiveIterator{
+private:
+    SLOT_ITERATOR _iter;
+    SLOT_ITERATOR _first;
+    SLOT_ITERATOR _last;
+    std::vector<char> const* _dead;     //one flag per slot, empty while there are no tombstones
 
-        iter->update_range(new_value);
-        double new_offset = iter->get_max();
+    bool is_dead()const{
+        return _iter != _last && !_dead->empty() && (*_dead)[_iter - _first];
+    }
 
-        for(++iter; iter != _range_list.end() ; ++iter){
-            iter->update_offset(new_offset);
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef typename std::iterator_traits<SLOT_ITERATOR>::value_type value_type;
+    typedef typename std::iterator_traits<SLOT_ITERATOR>::difference_type difference_type;
+    typedef typename std::iterator_traits<SLOT_ITERATOR>::pointer pointer;
+    typedef typename std::iterator_traits<SLOT_ITERATOR>::reference reference;
+
+    LiveIterator()
+    :_iter(),_first(),_last(),_dead(NULL)
+    {}
+
+    LiveIterator(SLOT_ITERATOR iter, SLOT_ITERATOR first, SLOT_ITERATOR last, std::vector<char> const* dead)
+    :_iter(iter),_first(first),_last(last),_dead(dead){
+
+        while(is_dead())
+            ++_iter;
+    }
+
+    /* the underlying slot */
+    SLOT_ITERATOR base()const{
+        return _iter;
+    }
+
+    reference operator*()const{
+        return *_iter;
+    }
+
+    pointer operator->()const{
+        return &*_iter;
+    }
+
+    LiveIterator& operator++(){
+        do{
+            ++_iter;
+        }while(is_dead());
+
+        return *this;
+    }
+
+    LiveIterator operator++(int){
+        LiveIterator copy(*this);
+        ++(*this);
+        return copy;
+    }
+
+    bool operator==(const LiveIterator& other)const{
+        return _iter == other._iter;
+    }
+
+    bool operator!=(const LiveIterator& other)const{
+        return _iter != other._iter;
+    }
+};
+
+/* ALLOC picks the storage of the table, e.g. HugePageAllocator for tables of millions of entries */
+template <typename T, typename ROLLER = NewRand, typename W = double, template<typename> class ALLOC = std::allocator>
+class Roulette{
+public:
+    typedef T value_type;
+    typedef W weight_type;
+    typedef RangedValue<T, W> ranged_value;
+    typedef std::vector<ranged_value, ALLOC<ranged_value> > storage_type;
+    typedef typename storage_type::iterator slot_iterator;
+    typedef LiveIterator<slot_iterator> iterator;
+private:
+    ROLLER _rand_gen;
+    storage_type _range_list;
+    W _last_val;
+    double _scale;                          //true weight = stored weight * _scale, stays 1 for integral weights
+
+    size_t _prefetch_depth;                 //0 when prefetching is off
+    size_t _prefetch_step;                  //draws added to the next batch per roll, it is complete once refill_threshold are left
+    mutable std::vector<size_t> _prefetched; //pre-drawn indices, consumed from the back
+    mutable std::vector<size_t> _pending;   //next batch, built a few draws per roll and swapped in once _prefetched runs out
+    mutable double _pending_point;          //fraction of the total the sweep building _pending last drew, points only go down
+    mutable size_t _pending_slot;           //slot that point landed in, the next one is searched for below it
+
+    bool _replicate;                        //keep per numa node copies of the upper bounds
+    NumaReplicas<W> _replicas;              //dropped by mutations, rebuilt by sync_replicas() or the next non-const roll()
+
+    bool _skew_search;                      //search through a mass bisection tree instead of plain binary search
+    MassBisectionTree<W> _skew_tree;        //dropped by mutations, rebuilt by sync_skew_search() or the next non-const roll()
+
+    double _compaction_ratio;               //0 when removal erases right away
+    std::vector<char> _dead;                //tombstone flag per slot, empty while there are none
+    std::vector<W> _slack;                  //stored mass at the top of each slot that no longer belongs to it, sized like _dead
+    std::vector<size_t> _free_slots;        //tombstoned slots, reused by insert from the back
+    size_t _tombstones;
+    W _dead_mass;                           //sum of _slack, rolls landing in it are drawn again
+
+protected:
+    /* first entry in [first, last) whose range ends above roll */
+    size_t find_index_in(W roll, size_t first, size_t last)const {
+
+        size_t start = first, fin = last, mid;
+
+        if(first >= last){
+            DBG_FORMAT_LINE("%s", __func__);
+            throw std::logic_error("cannot search an empty roulette");
+        }
+
+        while(start < fin){
+            mid = start + (fin - start)/2;
+
+            if(_range_list[mid] < roll)
+                start = mid+1;
+            else
+                fin = mid;
+        }
+
+        //a floating point roll can round up onto the total, fall back to the last entry holding any weight
+        if(start == last){
+            for(--start; start > first && _range_list[start].get_range() == W(0); --start);
+        }
+
+        return start;
+    }
+
+    /* first entry whose range ends above roll */
+    virtual size_t find_index(W roll)const {
+
+        if(_skew_tree.is_ready())
+            return _skew_tree.find(roll, [this](size_t i){ return _range_list[i].get_max(); });
+
+        if(_replicas.is_ready()){
+            W const* bounds = _replicas.local();
+            size_t start = std::upper_bound(bounds, bounds + _replicas.size(), roll) - bounds;
+
+            if(start == _replicas.size())
+                for(--start; start > 0 && bounds[start] == bounds[start - 1]; --start);
+
+            return start;
+        }
+
+        return find_index_in(roll, 0, _range_list.size());
+    }
+
+    static const size_t rejection_check = 64;  //misses between two has_live_weight() checks in rejection loops
+
+    /* one fresh draw, bypassing the prefetch buffer */
+    size_t draw_index()const{
+        return draw_index(_rand_gen);
+    }
+
+    /* one fresh draw from the given generator, only reads the table */
+    template<typename GEN>
+    size_t draw_index(GEN const& rand_gen)const{
+
+        if(!_dead_mass)
+            return find_index(WeightTraits<W>::draw(rand_gen, _last_val));
+
+        if(_tombstones == _range_list.size())
+            throw std::logic_error("cannot roll an empty roulette");
+
+        for(size_t misses = 1 ; ; ++misses){
+            W roll = WeightTraits<W>::draw(rand_gen, _last_val);
+            size_t index = find_index(roll);
+
+            if(is_live_at(index, roll))
+                return index;
+
+            if(!(misses % rejection_check) && !has_live_weight())
+                throw std::logic_error("cannot roll a roulette without live weight");
+        }
+    }
+
+    /*
+        exact check that some live entry still owns mass, O(n). rejection loops call it every rejection_check misses
+        since _dead_mass drifts under floating point and live entries can be updated down to 0
+    */
+    bool has_live_weight(std::vector<size_t> const& excluded = {})const{
+
+        for(size_t i = 0 ; i < _range_list.size() ; ++i)
+            if((_dead.empty() || !_dead[i]) && live_range(i) > W(0) && !std::binary_search(excluded.begin(), excluded.end(), i))
+                return true;
+
+        return false;
+    }
+
+    /* false when roll landed on a tombstone or on the slack of a reused slot */
+    bool is_live_at(size_t index, W roll)const{
+        return !_dead_mass || (!_dead[index] && roll < _range_list[index].get_max() - _slack[index]);
+    }
+
+    /* stored weight still owned by the entry in the slot */
+    W live_range(size_t index)const{
+        return _dead.empty() ? _range_list[index].get_range() : _range_list[index].get_range() - _slack[index];
+    }
+
+    /* first live slot holding value */
+    slot_iterator locate(T const & value){
+
+        for (auto iter = _range_list.begin() ; iter != _range_list.end(); ++iter)
+            if((_dead.empty() || !_dead[iter - _range_list.begin()]) && iter->get_value() == value)
+                return iter;
+
+        return _range_list.end();
+    }
+
+    /* marks the slot as a tombstone, its mass stays in the table until compact() */
+    void bury(slot_iterator iter){
+
+        if(_dead.empty()){
+            _dead.assign(_range_list.size(), 0);
+            _slack.assign(_range_list.size(), W(0));
+        }
+
+        size_t index = iter - _range_list.begin();
+
+        invalidate_caches();
+
+        _dead_mass += iter->get_range() - _slack[index];
+        _slack[index] = iter->get_range();
+        _dead[index] = 1;
+        _free_slots.push_back(index);
+        ++_tombstones;
+
+        //drop what the slot holds now, python objects would otherwise live until the compaction
+        if constexpr (std::is_default_constructible<T>::value && std::is_move_assignable<T>::value)
+            iter->get_value() = T();
+
+        //with a ratio of 1 the ratios alone never trigger, an all tombstone table is always compacted back to empty
+        if(_tombstones == _range_list.size() || _tombstones > _compaction_ratio * _range_list.size() || _dead_mass > _compaction_ratio * _last_val)
+            compact();
+    }
+
+    /* tombstoned slot able to hold stored, or the number of slots when there is none */
+    size_t reusable_slot(W stored)const{
+
+        if(!_free_slots.empty() && stored <= _range_list[_free_slots.back()].get_range())
+            return _free_slots.back();
+
+        return _range_list.size();
+    }
+
+    /* gives the slot returned by reusable_slot() back to a live entry of weight stored, the rest of it stays slack */
+    void revive(size_t index, W stored){
+        _free_slots.pop_back();
+        _dead[index] = 0;
+        _slack[index] = _range_list[index].get_range() - stored;
+        _dead_mass -= stored;
+        --_tombstones;
+    }
+
+    /* keeps the tombstone bookkeeping in step with an appended slot */
+    void track_appended(){
+        if(!_dead.empty()){
+            _dead.push_back(0);
+            _slack.push_back(W(0));
+        }
+    }
+
+    /* validates the chance of a new entry and returns it in stored form */
+    W stored_chance(W chance)const{
+
+        if (chance <= W(0))
+            throw std::invalid_argument("chance cannot be equal or less than 0");
+
+        chance = to_stored(chance);
+
+        if (chance > std::numeric_limits<W>::max() - _last_val)
+            throw std::overflow_error("total weight overflows the weight type");
+
+        return chance;
+    }
+
+    /* drops everything derived from the current table, called by every mutation */
+    void invalidate_caches(){
+        _prefetched.clear();
+        _pending.clear();
+        _replicas.clear();
+        _skew_tree.clear();
+    }
+
+    W to_stored(W weight)const{
+        return (_scale == 1.0)? weight : (W)(weight / _scale);
+    }
+
+    W from_stored(W stored)const{
+        return (_scale == 1.0)? stored : (W)(stored * _scale);
+    }
+
+    /* sets the stored weight of iter and shifts every later offset */
+    void update_at(slot_iterator iter, W stored){
+
+        if (stored > std::numeric_limits<W>::max() - (_last_val - iter->get_range()))
+            throw std::overflow_error("total weight overflows the weight type");
+
+        invalidate_caches();
+
+        //the whole slot goes to the new weight, any slack in it is gone
+        if(!_dead.empty()){
+            size_t index = iter - _range_list.begin();
+            _dead_mass -= _slack[index];
+            _slack[index] = W(0);
+        }
+
+        W new_offset = (iter == _range_list.begin())? W(0) : (iter - 1)->get_max();
+        iter->update_range(stored);
+
+        for(; iter != _range_list.end() ; ++iter){
+            iter->update_offset(new_offset);
             new_offset = iter->get_max();
         }
 
-        _last_val = new_offset;
+        _last_val = new_offset;
+    }
+
+    /* largest index holding any live weight, sweeps never move past it */
+    size_t last_weighted()const{
+        size_t last = _range_list.size() - 1;
+
+        for(; last > 0 && live_range(last) == W(0); --last);
+
+        return last;
+    }
+
+    /* n sorted points in [0, 1) from exponential spacings, written to points */
+    void sorted_uniforms(size_t n, std::vector<double>& points)const{
+
+        double running = 0;
+        points.resize(n + 1);
+
+        for(size_t k = 0 ; k <= n ; ++k)
+            points[k] = (running -= std::log(1.0 - _rand_gen(0.0, 1.0)));
+
+        for(size_t k = 0 ; k < n ; ++k)
+            points[k] /= running;
+
+        points.pop_back();
+    }
+
+    /* first entry at or below hi whose range ends above roll, gallops down from hi since sweeps only move down */
+    size_t sweep_index(W roll, size_t hi)const{
+
+        size_t lo = hi, step = 1;
+
+        while(lo > 0 && !(_range_list[lo - 1] < roll)){
+            hi = lo - 1;
+            lo = (lo > step)? lo - step : 0;
+            step <<= 1;
+        }
+
+        return find_index_in(roll, lo, hi + 1);
+    }
+
+    /*
+        adds up to count draws to the next prefetch batch. while the batch is dense in the table it is a sorted sweep down
+        it, every point is the largest of the uniforms still to come so each search gallops down from where the last one
+        ended and stays in cache, an inside out shuffle puts the draws in random order as they come in. sparse batches
+        (galloping costs twice the log of the gap between points) and tables with dead mass take plain draws instead
+    */
+    void extend_pending(size_t count)const{
+
+        size_t target = std::min(_prefetch_depth, _pending.size() + count);
+
+        if(_dead_mass || _prefetch_depth * _prefetch_depth < _range_list.size()){
+            while(_pending.size() < target)
+                _pending.push_back(draw_index());
+
+            return;
+        }
+
+        if(_pending.empty()){
+            _pending_point = 1.0;
+            _pending_slot = _range_list.size() - 1;
+        }
+
+        while(_pending.size() < target){
+            _pending_point *= std::pow(_rand_gen(0.0, 1.0), 1.0 / (_prefetch_depth - _pending.size()));
+
+            size_t index = _pending_slot = sweep_index((W)(_pending_point * (double)_last_val), _pending_slot);
+            size_t swap = _rand_gen((uint64_t)_pending.size() + 1);
+
+            if(swap == _pending.size()){
+                _pending.push_back(index);
+            }else{
+                _pending.push_back(_pending[swap]);
+                _pending[swap] = index;
+            }
+        }
+    }
+
+    /* lower bound of the range owned by index, index may be size() for the total */
+    W offset_of(size_t index)const{
+        return index ? _range_list[index - 1].get_max() : W(0);
+    }
+
+public:
+
+    Roulette(ROLLER rand_gen = ROLLER())
+    :_rand_gen(rand_gen)
+    ,_last_val(0)
+    ,_scale(1)
+    ,_prefetch_depth(0)
+    ,_prefetch_step(0)
+    ,_replicate(false)
+    ,_skew_search(false)
+    ,_compaction_ratio(0)
+    ,_tombstones(0)
+    ,_dead_mass(0)
+    {}
+    
+    Roulette(const std::initializer_list<std::pair<T, W> >& list, ROLLER rand_gen = ROLLER())
+    :_rand_gen(rand_gen)
+    ,_last_val(0)
+    ,_scale(1)
+    ,_prefetch_depth(0)
+    ,_prefetch_step(0)
+    ,_replicate(false)
+    ,_skew_search(false)
+    ,_compaction_ratio(0)
+    ,_tombstones(0)
+    ,_dead_mass(0)
+    {
+        reserve(list.size());
+
+        for(const auto& val : list)
+            insert(val.first, val.second);
+    }
+
+    /* from any range of (value, weight) pairs, values are moved out of the range when it yields rvalues (std::make_move_iterator) */
+    template<typename ITERATOR, typename = typename std::iterator_traits<ITERATOR>::iterator_category>
+    Roulette(ITERATOR first, ITERATOR last, ROLLER rand_gen = ROLLER())
+    :_rand_gen(rand_gen)
+    ,_last_val(0)
+    ,_scale(1)
+    ,_prefetch_depth(0)
+    ,_prefetch_step(0)
+    ,_replicate(false)
+    ,_skew_search(false)
+    ,_compaction_ratio(0)
+    ,_tombstones(0)
+    ,_dead_mass(0)
+    {
+        if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<ITERATOR>::iterator_category>::value)
+            reserve(std::distance(first, last));
+
+        for(; first != last ; ++first){
+            auto&& entry = *first;
+            insert(std::forward<decltype(entry)>(entry).first, entry.second);
+        }
+    }
+
+    Roulette(const Roulette& other)
+    :_rand_gen(other._rand_gen)
+    ,_range_list(other._range_list)
+    ,_last_val(other._last_val)
+    ,_scale(other._scale)
+    ,_prefetch_depth(other._prefetch_depth)
+    ,_prefetch_step(other._prefetch_step)
+    ,_replicate(other._replicate)
+    ,_skew_search(other._skew_search)
+    ,_compaction_ratio(other._compaction_ratio)
+    ,_dead(other._dead)
+    ,_slack(other._slack)
+    ,_free_slots(other._free_slots)
+    ,_tombstones(other._tombstones)
+    ,_dead_mass(other._dead_mass)
+    {
+        if(_replicate)
+            sync_replicas();
+
+        if(_skew_search)
+            sync_skew_search();
+    }
+
+    Roulette(Roulette&& other)
+    :_rand_gen(std::move(other._rand_gen))
+    ,_range_list(std::move(other._range_list))
+    ,_last_val(other._last_val)
+    ,_scale(other._scale)
+    ,_prefetch_depth(other._prefetch_depth)
+    ,_prefetch_step(other._prefetch_step)
+    ,_replicate(other._replicate)
+    ,_skew_search(other._skew_search)
+    ,_compaction_ratio(other._compaction_ratio)
+    ,_dead(std::move(other._dead))
+    ,_slack(std::move(other._slack))
+    ,_free_slots(std::move(other._free_slots))
+    ,_tombstones(other._tombstones)
+    ,_dead_mass(other._dead_mass)
+    {
+        other.clear();
+
+        if(_replicate)
+            sync_replicas();
+
+        if(_skew_search)
+            sync_skew_search();
+    }
+
+    Roulette& operator=(const Roulette& rhs){
+
+        if(this != &rhs){
+            Roulette copy(rhs);
+            *this = std::move(copy);
+        }
+
+        return *this;
+    }
+
+    Roulette& operator=(Roulette&& rhs){
+
+        if(this != &rhs){
+            invalidate_caches();
+
+            _rand_gen = std::move(rhs._rand_gen);
+            _range_list = std::move(rhs._range_list);
+            _last_val = rhs._last_val;
+            _scale = rhs._scale;
+            _prefetch_depth = rhs._prefetch_depth;
+            _prefetch_step = rhs._prefetch_step;
+            _replicate = rhs._replicate;
+            _skew_search = rhs._skew_search;
+            _compaction_ratio = rhs._compaction_ratio;
+            _dead = std::move(rhs._dead);
+            _slack = std::move(rhs._slack);
+            _free_slots = std::move(rhs._free_slots);
+            _tombstones = rhs._tombstones;
+            _dead_mass = rhs._dead_mass;
+
+            rhs.clear();
+
+            if(_replicate)
+                sync_replicas();
+
+            if(_skew_search)
+                sync_skew_search();
+        }
+
+        return *this;
+    }
+
+    virtual ~Roulette()
+    {}
+
+    /* live entries only, get_range()/get_max() are the raw slot bounds (see get_weight) */
+    virtual iterator begin(){ return iterator(_range_list.begin(), _range_list.begin(), _range_list.end(), &_dead); }
+    virtual iterator end(){ return iterator(_range_list.end(), _range_list.begin(), _range_list.end(), &_dead); }
+
+    /* slot at index, indices run up to slot_count() and may point at tombstones (see is_tombstone) */
+    virtual ranged_value& at(size_t index){ return _range_list.at(index); }
+    virtual ranged_value const& at(size_t index)const{ return _range_list.at(index); }
+
+    /* contiguous storage holding stored weights (see get_scale) and tombstones (see compact), valid until the next insert/update/remove */
+    virtual ranged_value const* data()const{ return _range_list.data(); }
+
+    virtual void insert(T val, W chance){
+
+        W stored = stored_chance(chance);
+        size_t slot = reusable_slot(stored);
+
+        invalidate_caches();
+
+        if(slot < _range_list.size()){
+            _range_list[slot].get_value() = std::move(val);
+            revive(slot, stored);
+            return;
+        }
+
+        _range_list.emplace_back(_last_val, _last_val + stored, std::move(val));
+        _last_val += stored;
+        track_appended();
+    }
+
+    /* builds the new value in place from args */
+    template<typename... ARGS>
+    void emplace(W chance, ARGS&&... args){
+
+        W stored = stored_chance(chance);
+        size_t slot = reusable_slot(stored);
+
+        invalidate_caches();
+
+        if(slot < _range_list.size()){
+            _range_list[slot].get_value() = T(std::forward<ARGS>(args)...);
+            revive(slot, stored);
+            return;
+        }
+
+        _range_list.emplace_back(_last_val, _last_val + stored, std::in_place, std::forward<ARGS>(args)...);
+        _last_val += stored;
+        track_appended();
+    }
+
+    virtual void reserve(size_t n){
+        _range_list.reserve(n);
+    }
+
+    /* removes every entry, prefetch and replication settings are kept */
+    virtual void clear(){
+        invalidate_caches();
+        _range_list.clear();
+        _last_val = 0;
+        _scale = 1;
+        _dead.clear();
+        _slack.clear();
+        _free_slots.clear();
+        _tombstones = 0;
+        _dead_mass = 0;
+    }
+
+    virtual iterator find(T const & value){
+        return iterator(locate(value), _range_list.begin(), _range_list.end(), &_dead);
+    }
+
+    /* slot of value, slot_count() when it is not in the roulette */
+    virtual size_t index_of(T const & value){
+        return locate(value) - _range_list.begin();
+    }
+
+    virtual bool remove(T const & value){
+        auto iter = locate(value);
+
+        if (iter == _range_list.end())
+            return false;
+
+        if (_compaction_ratio > 0){
+            bury(iter);
+            return true;
+        }
+
+        invalidate_caches();
+
+        auto to_remove_iter = iter;
+        W new_offset = (iter == _range_list.begin())? W(0) : (iter - 1)->get_max();
+
+        for(++iter; iter != _range_list.end() ; ++iter){
+            iter->update_offset(new_offset);
+            new_offset = iter->get_max();
+        }
+
+        _last_val = new_offset;
+
+        _range_list.erase(to_remove_iter);
+
+        return true;
+    }
+
+    virtual bool update(T const& value, W new_value){
+
+        if (new_value < W(0))
+            throw std::invalid_argument("chance cannot be less than 0");
+
+        auto iter = locate(value);
+
+        if (iter == _range_list.end())
+            return false;
+
+        update_at(iter, to_stored(new_value));
+
+        return true;
+    }
+
+    /* adds delta to the weight of value, inserting it when it is not in the roulette */
+    virtual void add(T value, W delta){
+
+        auto iter = locate(value);
+
+        if (iter == _range_list.end()){
+            insert(std::move(value), delta);
+            return;
+        }
+
+        W current = from_stored(live_range(iter - _range_list.begin()));
+
+        if (delta > std::numeric_limits<W>::max() - current)
+            throw std::overflow_error("total weight overflows the weight type");
+
+        if (current + delta < W(0))
+            throw std::invalid_argument("chance cannot be less than 0");
+
+        update_at(iter, to_stored(current + delta));
+    }
+
+    /*
+        multiplies every weight by factor in O(1), the weights are kept in scaled form behind one global multiplier,
+        they are folded back into the table once the multiplier gets close to the limits of the weight type
+    */
+    virtual void scale_all(double factor){
+
+        if (!std::is_floating_point<W>::value)
+            throw std::logic_error("scaling needs a floating point weight type");
+
+        if (!(factor > 0) || std::isinf(factor))
+            throw std::invalid_argument("scale factor must be a positive finite number");
+
+        _scale *= factor;
+
+        if (_scale < std::sqrt((double)std::numeric_limits<W>::min()) || _scale > std::sqrt((double)std::numeric_limits<W>::max()))
+            normalize();
+    }
+
+    /* folds the global multiplier back into the stored weights, O(n) and only needed before reading raw storage */
+    virtual void normalize(){
+
+        if (_scale == 1.0)
+            return;
+
+        //every bound moves, the skew tree and the numa replicas hold copies of the old ones
+        invalidate_caches();
+
+        W new_offset = 0;
+
+        for(auto iter = _range_list.begin(); iter != _range_list.end() ; ++iter){
+            iter->update_range(from_stored(iter->get_range()));
+            iter->update_offset(new_offset);
+            new_offset = iter->get_max();
+        }
+
+        _dead_mass = 0;
+
+        for(auto& slack : _slack)
+            _dead_mass += (slack = from_stored(slack));
+
+        _last_val = new_offset;
+        _scale = 1.0;
+    }
+
+    /*
+        with a positive compaction_ratio remove() only marks the entry as a tombstone in O(1): its slot keeps its mass,
+        rolls landing there are drawn again and insert() reuses the slot when the new weight fits in it.
+        storage is compacted in one O(n) pass once tombstones exceed compaction_ratio of the slots or of the total mass,
+        0 goes back to erasing right away
+    */
+    virtual void set_lazy_removal(double compaction_ratio){
+
+        if(!(compaction_ratio >= 0 && compaction_ratio <= 1))
+            throw std::invalid_argument("compaction ratio must be between 0 and 1");
+
+        _compaction_ratio = compaction_ratio;
+
+        if(!compaction_ratio)
+            compact();
+    }
+
+    virtual double get_compaction_ratio()const{
+        return _compaction_ratio;
+    }
+
+    /* drops every tombstone and slack in one pass, moves entries to new slots */
+    virtual void compact(){
+
+        if(_dead.empty())
+            return;
+
+        invalidate_caches();
+
+        W new_offset = 0;
+        size_t kept = 0;
+
+        for(size_t i = 0 ; i < _range_list.size() ; ++i){
+            if(_dead[i])
+                continue;
+
+            W live = _range_list[i].get_range() - _slack[i];
+
+            if(kept != i)
+                _range_list[kept] = std::move(_range_list[i]);
+
+            _range_list[kept].update_offset(new_offset);
+            _range_list[kept].update_range(live);
+            new_offset = _range_list[kept].get_max();
+            ++kept;
+        }
+
+        _range_list.erase(_range_list.begin() + kept, _range_list.end());
+        _last_val = new_offset;
+
+        _dead.clear();
+        _slack.clear();
+        _free_slots.clear();
+        _tombstones = 0;
+        _dead_mass = 0;
+    }
+
+    virtual size_t tombstone_count()const{
+        return _tombstones;
+    }
+
+    virtual bool is_tombstone(size_t index)const{
+        return !_dead.empty() && _dead.at(index);
+    }
+
+    virtual double get_scale()const{
+        return _scale;
+    }
+
+    /* true weight of the entry at index, 0 for a tombstone */
+    virtual W get_weight(size_t index)const{
+        return from_stored(_range_list.at(index).get_range() - (_dead.empty() ? W(0) : _slack[index]));
+    }
+
+    /* live entries, tombstones are not counted */
+    virtual size_t size()const{
+        return _range_list.size() - _tombstones;
+    }
+
+    /* slots in storage, the bound of every index */
+    virtual size_t slot_count()const{
+        return _range_list.size();
+    }
+
+    virtual W get_total()const{
+        return from_stored(_last_val - _dead_mass);
+    }
+
+    /*
+        keeps up to depth pre-drawn indices so roll() is a single pop in the common case. the next batch is built
+        alongside, a few draws per roll so no single roll pays for a whole batch, and is complete once refill_threshold
+        draws are left. both are dropped by any mutation, depth 0 turns prefetching off
+    */
+    virtual void set_prefetch(size_t depth, size_t refill_threshold = 0){
+
+        if(depth && refill_threshold >= depth)
+            throw std::invalid_argument("refill threshold must be less than the prefetch depth");
+
+        _prefetch_depth = depth;
+        _prefetch_step = depth ? (depth + (depth - refill_threshold) - 1) / (depth - refill_threshold) : 0;
+        _prefetched.clear();
+        _prefetched.shrink_to_fit();
+        _prefetched.reserve(depth);
+        _pending.clear();
+        _pending.shrink_to_fit();
+        _pending.reserve(depth);
+    }
+
+    virtual size_t get_prefetch_depth()const{
+        return _prefetch_depth;
+    }
+
+    virtual size_t roll_index()const{
+
+        if(!_prefetch_depth)
+            return draw_index();
+
+        if(_prefetched.empty() && _pending.size() == _prefetch_depth)
+            _prefetched.swap(_pending);
+
+        extend_pending(_prefetch_step);
+
+        //right after a mutation there is nothing ready yet, roll directly while the first batch builds up
+        if(_prefetched.empty())
+            return draw_index();
+
+        size_t index = _prefetched.back();
+        _prefetched.pop_back();
+
+        return index;
+    }
+
+    /*
+        keeps a copy of the upper bounds on every numa node so each thread searches memory local to it,
+        mutations drop the copies until sync_replicas() or the next non-const roll() rebuilds them
+    */
+    virtual void replicate_per_node(bool enable){
+        _replicate = enable;
+
+        if(enable)
+            sync_replicas();
+        else
+            _replicas.clear();
+    }
+
+    virtual void sync_replicas(){
+        if(_replicate && !_replicas.is_ready())
+            _replicas.build([this](size_t i){ return _range_list[i].get_max(); }, _range_list.size());
+    }
+
+    /*
+        searches through a MassBisectionTree, worth it when a few entries hold most of the weight (zipf like tables),
+        mutations drop the tree until sync_skew_search() or the next non-const roll() rebuilds it in O(n log n)
+    */
+    virtual void set_skew_search(bool enable){
+        _skew_search = enable;
+
+        if(enable)
+            sync_skew_search();
+        else
+            _skew_tree.clear();
+    }
+
+    virtual bool get_skew_search()const{
+        return _skew_search;
+    }
+
+    virtual void sync_skew_search(){
+        if(_skew_search && !_skew_tree.is_ready())
+            _skew_tree.build([this](size_t i){ return _range_list[i].get_max(); }, _range_list.size());
+    }
+
+    /* a fresh 64 bit word from the roulette generator, e.g. to seed roll_parallel() ahead of time */
+    virtual uint64_t draw_seed()const{
+        return _rand_gen(std::numeric_limits<uint64_t>::max());
+    }
+
+    /* roll_parallel seeded from the roulette generator, which is advanced by one draw */
+    virtual void roll_parallel(size_t n, size_t* out, size_t threads = 0)const{
+        roll_parallel(n, out, threads, draw_seed());
+    }
+
+    /*
+        writes n independent draws to out using up to threads workers (0 for one per core), the calling thread is one of them.
+        every worker owns a NewRand stream seeded from seed and jumped 2^128 draws away from the others, and claims chunks of out
+        from a shared counter so a slow worker never holds the others back. only the table is read, never the roulette generator,
+        so other threads may keep rolling meanwhile, but the table must not change until this returns
+    */
+    virtual void roll_parallel(size_t n, size_t* out, size_t threads, uint64_t seed)const{
+
+        const size_t chunk = 1 << 14;
+
+        if(!n)
+            return;
+
+        if(is_empty())
+            throw std::logic_error("cannot roll an empty roulette");
+
+        if(!threads)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        threads = std::min(threads, (n + chunk - 1) / chunk);
+
+        NewRand stream(seed);
+        std::atomic<size_t> next(0);
+        std::vector<std::exception_ptr> errors(threads);
+        std::vector<std::thread> workers;
+
+        auto work = [&](NewRand rand_gen, size_t worker){
+            try{
+                for(size_t first ; (first = next.fetch_add(chunk, std::memory_order_relaxed)) < n ;){
+                    size_t last = std::min(n, first + chunk);
+
+                    for(size_t i = first ; i < last ; ++i)
+                        out[i] = draw_index(rand_gen);
+                }
+            }catch(...){
+                errors[worker] = std::current_exception();
+                next.store(n, std::memory_order_relaxed);
+            }
+        };
+
+        NewRand own_stream(stream);
+
+        try{
+            workers.reserve(threads - 1);
+
+            for(size_t worker = 1 ; worker < threads ; ++worker){
+                stream.jump();
+                workers.emplace_back(work, stream, worker);
+            }
+        }catch(...){
+            next.store(n, std::memory_order_relaxed);
+
+            for(auto& thread : workers)
+                thread.join();
+
+            throw;
+        }
+
+        work(own_stream, 0);
 
-        return true;
+        for(auto& thread : workers)
+            thread.join();
+
+        for(auto const& error : errors)
+            if(error)
+                std::rethrow_exception(error);
     }
 
-    virtual size_t size()const{
-        return _range_list.size();
+    /*
+        index picked by hash alone: the same hash lands on the same entry as long as the table does not change,
+        no generator is involved. the hash is laid over the cumulative table, so changing one weight by d only moves
+        the keys lying within d of a shifted boundary, about (entries after it) * d / total of them
+    */
+    virtual size_t roll_index_for_hash(uint64_t hash)const{
+
+        if(is_empty())
+            throw std::logic_error("cannot roll an empty roulette");
+
+        for(size_t misses = 1 ; ; ++misses){
+            W roll = WeightTraits<W>::point(hash, _last_val);
+            size_t index = find_index(roll);
+
+            if(is_live_at(index, roll))
+                return index;
+
+            if(!(misses % rejection_check) && !has_live_weight())
+                throw std::logic_error("cannot roll a roulette without live weight");
+
+            //landed on a tombstone, walk on to the next point of the same key
+            hash = mix64(hash + 0x9E3779B97F4A7C15ULL);
+        }
+    }
+
+    /* sticky draw for key, see roulette_key_hash for how keys are hashed */
+    template<typename KEY>
+    size_t roll_index_for(KEY const& key)const{
+        return roll_index_for_hash(roulette_key_hash(key));
+    }
+
+    template<typename KEY>
+    T const & roll_for(KEY const& key)const{
+        return _range_list[roll_index_for(key)].get_value();
+    }
+
+    template<typename KEY>
+    T& roll_for(KEY const& key){
+        return _range_list[roll_index_for(key)].get_value();
+    }
+
+    /* roll_index_for over every key in [first, last), indices are written to out */
+    template<typename KEY_ITERATOR, typename OUT_ITERATOR>
+    OUT_ITERATOR roll_index_for_many(KEY_ITERATOR first, KEY_ITERATOR last, OUT_ITERATOR out)const{
+
+        for(; first != last ; ++first, ++out)
+            *out = roll_index_for(*first);
+
+        return out;
     }
 
     virtual T const & roll() const{
-        return _range_list[find_index(_rand_gen(0,_last_val))].get_value();
+        return _range_list[roll_index()].get_value();
     }
 
     virtual T& roll(){
-        return _range_list[find_index(_rand_gen(0,_last_val))].get_value();
+        sync_replicas();
+        sync_skew_search();
+        return _range_list[roll_index()].get_value();
+    }
+
+    /* index drawn only among the entries in [first, last), the table is left untouched */
+    virtual size_t roll_index_range(size_t first, size_t last)const{
+
+        if(first >= last || last > _range_list.size())
+            throw std::out_of_range("invalid entry range");
+
+        W low = offset_of(first), mass = _range_list[last - 1].get_max() - low, live = mass;
+
+        if(_dead_mass){
+            live = 0;
+
+            for(size_t i = first ; i < last ; ++i)
+                live += live_range(i);
+        }
+
+        if(live <= W(0))
+            throw std::invalid_argument("range holds no weight");
+
+        for(;;){
+            W roll = low + WeightTraits<W>::draw(_rand_gen, mass);
+            size_t index = find_index_in(roll, first, last);
+
+            if(is_live_at(index, roll))
+                return index;
+        }
+    }
+
+    virtual T const & roll_range(size_t first, size_t last) const{
+        return _range_list[roll_index_range(first, last)].get_value();
+    }
+
+    virtual T& roll_range(size_t first, size_t last){
+        return _range_list[roll_index_range(first, last)].get_value();
+    }
+
+    /* index drawn as if the k excluded slot indices had no weight, costs O(k log k + log n) and leaves the table untouched */
+    virtual size_t roll_index_excluding(std::vector<size_t> excluded)const{
+
+        std::sort(excluded.begin(), excluded.end());
+        excluded.erase(std::unique(excluded.begin(), excluded.end()), excluded.end());
+
+        if(!excluded.empty() && excluded.back() >= _range_list.size())
+            throw std::out_of_range("excluded index out of range");
+
+        W removed = 0, removed_live = 0;
+
+        for(size_t index : excluded){
+            removed += _range_list[index].get_range();
+            removed_live += live_range(index);
+        }
+
+        if(_last_val - _dead_mass - removed_live <= W(0))
+            throw std::invalid_argument("no weight left after exclusion");
+
+        for(size_t misses = 1 ; ; ++misses){
+            //draw over the remaining mass, then step over every excluded range lying below the roll
+            W roll = WeightTraits<W>::draw(_rand_gen, _last_val - removed);
+
+            for(size_t index : excluded){
+                if(roll < offset_of(index))
+                    break;
+
+                roll += _range_list[index].get_range();
+            }
+
+            size_t found = find_index_in(roll, 0, _range_list.size());
+            bool allowed = !std::binary_search(excluded.begin(), excluded.end(), found);
+
+            if(roll >= _last_val){
+                //rounding pushed the roll past the end, back off to the closest entry still allowed
+                while(found > 0 && (live_range(found) == W(0) || !allowed))
+                    allowed = !std::binary_search(excluded.begin(), excluded.end(), --found);
+
+                if(allowed && live_range(found) > W(0))
+                    return found;
+            }else if(allowed && is_live_at(found, roll)){
+                //tombstones and slack are rejected like draw_index() does, never handed to a neighbour
+                return found;
+            }
+
+            if(!(misses % rejection_check) && !has_live_weight(excluded))
+                throw std::invalid_argument("no weight left after exclusion");
+        }
+    }
+
+    virtual T const & roll_excluding(std::vector<size_t> const& excluded) const{
+        return _range_list[roll_index_excluding(excluded)].get_value();
+    }
+
+    virtual T& roll_excluding(std::vector<size_t> const& excluded){
+        return _range_list[roll_index_excluding(excluded)].get_value();
+    }
+
+    /*
+        draws n indices in one linear sweep over the table, O(n + size()) with sequential memory access,
+        the indices are written to out in ascending order
+    */
+    template<typename OUT_ITERATOR>
+    OUT_ITERATOR resample(size_t n, OUT_ITERATOR out, resample_method method = RESAMPLE_MULTINOMIAL)const{
+
+        if(!n)
+            return out;
+
+        if(_range_list.empty() || _last_val - _dead_mass <= W(0))
+            throw std::logic_error("cannot resample an empty roulette");
+
+        //positions are laid over the live mass only, tombstones and slack take no room in the sweep
+        const double total = (double)(_last_val - _dead_mass);
+        const size_t last = last_weighted();
+        size_t index = 0;
+        double live_bound = (double)live_range(0);
+        std::vector<double> points;
+
+        //advances to the entry owning position, positions must arrive in ascending order
+        auto owner = [&](double position) -> size_t {
+            while(index < last && (_dead.empty() ? (double)_range_list[index].get_max() : live_bound) <= position)
+                live_bound += (double)live_range(++index);
+            return index;
+        };
+
+        switch(method){
+            case RESAMPLE_SYSTEMATIC:{
+                double offset = _rand_gen(0.0, 1.0);
+
+                for(size_t k = 0 ; k < n ; ++k, ++out)
+                    *out = owner((k + offset) / n * total);
+                break;
+            }
+            case RESAMPLE_STRATIFIED:
+                for(size_t k = 0 ; k < n ; ++k, ++out)
+                    *out = owner((k + _rand_gen(0.0, 1.0)) / n * total);
+                break;
+            case RESAMPLE_RESIDUAL:{
+                std::vector<size_t> counts(_range_list.size());
+                std::vector<double> residual_bounds(_range_list.size());
+                double residual_total = 0;
+                size_t assigned = 0;
+
+                for(size_t i = 0 ; i < _range_list.size() ; ++i){
+                    double expected = n * ((double)live_range(i) / total);
+                    counts[i] = std::min((size_t)expected, n - assigned);
+                    assigned += counts[i];
+                    residual_bounds[i] = (residual_total += expected - counts[i]);
+                }
+
+                sorted_uniforms(n - assigned, points);
+
+                for(double point : points){
+                    while(index < last && residual_bounds[index] <= point * residual_total)
+                        ++index;
+                    ++counts[index];
+                }
+
+                for(size_t i = 0 ; i < counts.size() ; ++i)
+                    for(size_t c = 0 ; c < counts[i] ; ++c, ++out)
+                        *out = i;
+                break;
+            }
+            case RESAMPLE_MULTINOMIAL:
+            default:
+                sorted_uniforms(n, points);
+
+                for(double point : points){
+                    *out = owner(point * total);
+                    ++out;
+                }
+                break;
+        }
+
+        return out;
     }
 
     virtual bool is_empty()const{
-        return _range_list.empty();
+        return size() == 0;
+    }
+};
+
+/* fixed size roulette, its cumulative table can be built in a constexpr context so it never allocates and has no virtual calls */
+template <typename T, size_t N, typename W = double>
+class StaticRoulette{
+    static_assert(N > 0, "a static roulette needs at least one value");
+
+public:
+    typedef W weight_type;
+
+private:
+    std::array<T, N> _values;
+    std::array<W, N> _bounds; //cumulative upper bound of every value
+
+    constexpr void push(size_t index, T const& value, W chance, W& total){
+
+        if (chance <= W(0))
+            throw std::invalid_argument("chance cannot be equal or less than 0");
+
+        if (chance > std::numeric_limits<W>::max() - total)
+            throw std::overflow_error("total weight overflows the weight type");
+
+        _values[index] = value;
+        _bounds[index] = (total += chance);
+    }
+
+    /* first value whose range ends above roll, same search as Roulette::find_index */
+    constexpr size_t find_index(W roll)const {
+
+        size_t start = 0, fin = N, mid = 0;
+
+        while(start < fin){
+            mid = start + (fin - start)/2;
+
+            if(_bounds[mid] <= roll)
+                start = mid+1;
+            else
+                fin = mid;
+        }
+
+        if(start == N)
+            --start;
+
+        return start;
+    }
+
+public:
+
+    constexpr StaticRoulette(const T (&values)[N], const W (&chances)[N])
+    :_values()
+    ,_bounds()
+    {
+        W total = 0;
+
+        for(size_t i = 0 ; i < N ; ++i)
+            push(i, values[i], chances[i], total);
+    }
+
+    constexpr StaticRoulette(const std::pair<T, W> (&list)[N])
+    :_values()
+    ,_bounds()
+    {
+        W total = 0;
+
+        for(size_t i = 0 ; i < N ; ++i)
+            push(i, list[i].first, list[i].second, total);
+    }
+
+    constexpr size_t size()const{
+        return N;
+    }
+
+    constexpr W get_total()const{
+        return _bounds[N - 1];
+    }
+
+    constexpr T const& get_value(size_t index)const{
+        return _values[index];
+    }
+
+    constexpr W get_range(size_t index)const{
+        return index ? _bounds[index] - _bounds[index - 1] : _bounds[0];
+    }
+
+    template<typename ROLLER>
+    T const& roll(const ROLLER& rand_gen)const{
+        return _values[find_index(WeightTraits<W>::draw(rand_gen, get_total()))];
+    }
+};
+
+/* many small distributions packed in one CSR layout, row r owns entries [offsets[r], offsets[r+1]) of the value and bound arrays */
+template <typename T, typename ROLLER = NewRand, typename W = double>
+class RouletteBank{
+public:
+    typedef W weight_type;
+
+private:
+    ROLLER _rand_gen;
+    std::vector<T> _values;
+    std::vector<W> _bounds;       //cumulative upper bounds, restarting at 0 on every row
+    std::vector<size_t> _offsets; //rows()+1 entries, the first is always 0
+
+    void check_row(size_t row)const{
+        if(row >= rows())
+            throw std::out_of_range("row out of range");
+    }
+
+    /* first entry of the row whose range ends above roll, same search as Roulette::find_index */
+    size_t find_index(size_t row, W roll)const{
+
+        size_t start = _offsets[row], fin = _offsets[row + 1], mid;
+
+        while(start < fin){
+            mid = start + (fin - start)/2;
+
+            if(_bounds[mid] <= roll)
+                start = mid+1;
+            else
+                fin = mid;
+        }
+
+        if(start == _offsets[row + 1])
+            --start;
+
+        return start;
+    }
+
+public:
+
+    RouletteBank(ROLLER rand_gen = ROLLER())
+    :_rand_gen(rand_gen)
+    ,_offsets(1, 0)
+    {}
+
+    void reserve(size_t rows, size_t entries){
+        _offsets.reserve(rows + 1);
+        _values.reserve(entries);
+        _bounds.reserve(entries);
+    }
+
+    /* appends a distribution from a range of (value, weight) pairs and returns its row */
+    template<typename ITERATOR>
+    size_t add_row(ITERATOR first, ITERATOR last){
+
+        W total = 0;
+
+        for(ITERATOR iter = first ; iter != last ; ++iter){
+            if (iter->second <= W(0))
+                throw std::invalid_argument("chance cannot be equal or less than 0");
+
+            if (iter->second > std::numeric_limits<W>::max() - total)
+                throw std::overflow_error("total weight overflows the weight type");
+
+            total += iter->second;
+        }
+
+        if(first == last)
+            throw std::invalid_argument("a row needs at least one value");
+
+        total = 0;
+
+        for(ITERATOR iter = first ; iter != last ; ++iter){
+            _values.push_back(iter->first);
+            _bounds.push_back(total += iter->second);
+        }
+
+        _offsets.push_back(_values.size());
+
+        return rows() - 1;
+    }
+
+    size_t add_row(const std::initializer_list<std::pair<T, W> >& list){
+        return add_row(list.begin(), list.end());
+    }
+
+    size_t rows()const{
+        return _offsets.size() - 1;
+    }
+
+    size_t size()const{
+        return _values.size();
+    }
+
+    /* flat index of the first entry of row */
+    size_t row_begin(size_t row)const{
+        check_row(row);
+        return _offsets[row];
+    }
+
+    size_t row_size(size_t row)const{
+        check_row(row);
+        return _offsets[row + 1] - _offsets[row];
+    }
+
+    W get_total(size_t row)const{
+        check_row(row);
+        return _bounds[_offsets[row + 1] - 1];
+    }
+
+    T const& get_value(size_t index)const{
+        return _values.at(index);
+    }
+
+    W get_range(size_t index)const{
+        size_t row_begin = *(std::upper_bound(_offsets.begin(), _offsets.end(), index) - 1);
+        return (index == row_begin)? _bounds.at(index) : _bounds.at(index) - _bounds[index - 1];
+    }
+
+    /* index into the flat value array of an entry drawn from row */
+    size_t roll_index(size_t row)const{
+        check_row(row);
+        return find_index(row, WeightTraits<W>::draw(_rand_gen, _bounds[_offsets[row + 1] - 1]));
+    }
+
+    T const& roll(size_t row)const{
+        return _values[roll_index(row)];
+    }
+
+    /* draws once from every row in [first, last), writing flat value indices to out */
+    template<typename ROW_ITERATOR, typename OUT_ITERATOR>
+    OUT_ITERATOR roll_rows(ROW_ITERATOR first, ROW_ITERATOR last, OUT_ITERATOR out)const{
+
+        for(; first != last ; ++first, ++out)
+            *out = roll_index((size_t)*first);
+
+        return out;
+    }
+};
+
+/* walker/vose alias table, draws one of n weighted columns from a single uniform number in O(1) */
+class AliasTable{
+private:
+    std::vector<double> _probability;   //chance of keeping the column, otherwise its alias is taken
+    std::vector<size_t> _alias;
+
+public:
+
+    /* O(n) from a range of non negative weights with a positive sum */
+    template<typename ITERATOR>
+    void build(ITERATOR first, ITERATOR last){
+
+        std::vector<double> scaled(first, last);
+        std::vector<size_t> small, large;
+        double total = 0;
+
+        for(double weight : scaled){
+            if(!(weight >= 0) || std::isinf(weight))
+                throw std::invalid_argument("weights must be non negative finite numbers");
+
+            total += weight;
+        }
+
+        if(!(total > 0))
+            throw std::invalid_argument("weights must not all be 0");
+
+        _probability.assign(scaled.size(), 1.0);
+        _alias.resize(scaled.size());
+
+        for(size_t i = 0 ; i < scaled.size() ; ++i){
+            _alias[i] = i;
+            scaled[i] *= scaled.size() / total;
+            (scaled[i] < 1.0 ? small : large).push_back(i);
+        }
+
+        while(!small.empty() && !large.empty()){
+            size_t light = small.back(), heavy = large.back();
+            small.pop_back();
+
+            _probability[light] = scaled[light];
+            _alias[light] = heavy;
+
+            scaled[heavy] -= 1.0 - scaled[light];
+
+            if(scaled[heavy] < 1.0){
+                large.pop_back();
+                small.push_back(heavy);
+            }
+        }
+
+        //whatever is left only misses 1 by rounding and keeps itself
+    }
+
+    size_t size()const{
+        return _probability.size();
+    }
+
+    template<typename ROLLER>
+    size_t draw(const ROLLER& rand_gen)const{
+
+        if(_probability.empty())
+            throw std::logic_error("cannot draw from an empty alias table");
+
+        double point = rand_gen(0.0, (double)_probability.size());
+        size_t column = std::min((size_t)point, _probability.size() - 1);
+
+        return (point - column < _probability[column])? column : _alias[column];
+    }
+};
+
+/*
+    weighted mixture of existing roulettes sampled without merging their tables: an alias table picks the component in O(1),
+    then that component rolls as usual. components are referenced, not copied, so their updates show up right away
+    and they must outlive the mixture
+*/
+template<typename ROULETTE, typename ROLLER = NewRand>
+class RouletteMixture{
+public:
+    typedef typename ROULETTE::value_type value_type;
+
+private:
+    ROLLER _rand_gen;
+    std::vector<ROULETTE*> _components;
+    std::vector<double> _weights;
+    AliasTable _table;
+
+public:
+
+    RouletteMixture(ROLLER rand_gen = ROLLER())
+    :_rand_gen(rand_gen)
+    {}
+
+    RouletteMixture(const std::initializer_list<std::pair<ROULETTE*, double> >& list, ROLLER rand_gen = ROLLER())
+    :_rand_gen(rand_gen)
+    {
+        for(const auto& component : list)
+            add(*component.first, component.second);
+    }
+
+    /* O(number of components), the table is rebuilt */
+    void add(ROULETTE& component, double weight){
+
+        if(!(weight > 0) || std::isinf(weight))
+            throw std::invalid_argument("mixture weight must be a positive finite number");
+
+        _weights.push_back(weight);
+
+        try{
+            _table.build(_weights.begin(), _weights.end());
+        }catch(...){
+            _weights.pop_back();
+            throw;
+        }
+
+        _components.push_back(&component);
+    }
+
+    size_t size()const{
+        return _components.size();
+    }
+
+    ROULETTE& component(size_t index)const{
+        return *_components.at(index);
+    }
+
+    double get_weight(size_t index)const{
+        return _weights.at(index);
+    }
+
+    /* index of the component the next draw comes from */
+    size_t roll_component()const{
+
+        if(_components.empty())
+            throw std::logic_error("cannot roll an empty mixture");
+
+        return _table.draw(_rand_gen);
+    }
+
+    value_type& roll(){
+        return _components[roll_component()]->roll();
     }
 };
 
@@ -0,0 +1,70 @@
+#include "roulette.hpp"
+#include <iostream>
+#include <iomanip>
+
+#define ROLLS 10000000
+
+using std::cout;
+using std::endl;
+
+/* entropy in bits of the roulette weights, the best any comparison search can do on average */
+double entropy(Roulette<size_t> const& roulette){
+
+    double bits = 0, total = roulette.get_total();
+
+    for(size_t i = 0 ; i < roulette.slot_count() ; ++i){
+        double p = roulette.get_weight(i) / total;
+        bits -= p * std::log2(p);
+    }
+
+    return bits;
+}
+
+/* nanoseconds per roll_index() */
+double time_rolls(Roulette<size_t> const& roulette){
+
+    size_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for(int i = 0 ; i < ROLLS ; ++i)
+        checksum += roulette.roll_index();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if(checksum == (size_t)-1)
+        cout << checksum << endl;
+
+    return seconds * 1e9 / ROLLS;
+}
+
+/* zipf(1.0) tables, entries shuffled since production tables are not kept sorted by weight */
+int main(int argc, char* argv[]){
+
+    NewRand shuffle_rand(7);
+
+    cout << std::fixed << std::setprecision(1);
+    cout << "entries    log2(n)  entropy  binary ns  skew ns" << endl;
+
+    for(size_t n : {1000, 100000, 1000000, 10000000}){
+        std::vector<std::pair<size_t, double> > entries;
+
+        entries.reserve(n);
+
+        for(size_t rank = 1 ; rank <= n ; ++rank)
+            entries.emplace_back(rank, 1.0 / rank);
+
+        for(size_t i = n - 1 ; i > 0 ; --i)
+            std::swap(entries[i], entries[shuffle_rand(i + 1)]);
+
+        Roulette<size_t> roulette(entries.begin(), entries.end());
+
+        double binary_ns = time_rolls(roulette);
+        roulette.set_skew_search(true);
+        double skew_ns = time_rolls(roulette);
+
+        cout << std::setw(8) << n << std::setw(11) << std::log2((double)n) << std::setw(9) << entropy(roulette)
+             << std::setw(11) << binary_ns << std::setw(9) << skew_ns << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+#ifndef __ROULETTE_CAPI_H__
+#define __ROULETTE_CAPI_H__
+
+/*
+    c api of the roulette module, exported as the capsule roulette._C_API in the style of datetime.datetime_CAPI.
+
+    usage from another extension:
+
+        #include "roulette_capi.h"
+
+        Roulette_IMPORT;                                        // once, e.g. in PyInit_<module>, NULL + exception on failure
+        if(RouletteAPI->version < ROULETTE_CAPI_VERSION) ...     // fields are only ever appended
+
+        PyObject* value = RouletteAPI->roll(py_roulette);
+*/
+
+#include <Python.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ROULETTE_CAPI_VERSION 1
+#define ROULETTE_CAPSULE_NAME "roulette._C_API"
+
+/* weight representation picked with roulette(weight_type=...) */
+#define ROULETTE_WEIGHT_DOUBLE 0
+#define ROULETTE_WEIGHT_FLOAT  1
+#define ROULETTE_WEIGHT_UINT32 2
+#define ROULETTE_WEIGHT_UINT64 3
+
+/*
+    every function needs the GIL and fails with -1 (NULL for pointers) and a python exception set,
+    unless its comment says otherwise
+*/
+typedef struct {
+    int version;                    /* ROULETTE_CAPI_VERSION the module was built with */
+    size_t struct_size;             /* sizeof(Roulette_CAPI) in the module */
+
+    PyTypeObject* RouletteType;
+
+    /* 1 when object is a roulette.roulette (or a subclass), 0 otherwise, never fails */
+    int (*check)(PyObject* object);
+
+    /* live elements, removed ones left as tombstones are not counted */
+    Py_ssize_t (*size)(PyObject* roulette);
+
+    /* one of ROULETTE_WEIGHT_* */
+    int (*weight_kind)(PyObject* roulette);
+
+    /* new reference to a randomly chosen element */
+    PyObject* (*roll)(PyObject* roulette);
+
+    /* writes n new references to out, returns n, nothing is left in out on failure */
+    Py_ssize_t (*roll_into)(PyObject* roulette, PyObject** out, Py_ssize_t n);
+
+    /*
+        writes n element indices to out, returns n or -1 when the roulette is empty.
+        uses no python api and sets no exception, so it may run with the GIL released
+        as long as no other thread uses or modifies the roulette meanwhile
+    */
+    Py_ssize_t (*roll_indices)(PyObject* roulette, Py_ssize_t* out, Py_ssize_t n);
+
+    /* borrowed reference to the element at index, indices are slots as written by roll_indices */
+    PyObject* (*value_at)(PyObject* roulette, Py_ssize_t index);
+
+    /* 1 and the chance of key in *weight when key is in the roulette, 0 when it is not */
+    int (*lookup)(PyObject* roulette, PyObject* key, double* weight);
+
+    /*
+        the underlying Roulette<PythonSmartPointer, NewRand, W>, W picked by weight_kind (see RouletteCapiHandler),
+        only usable from c++ built against the same roulette.hpp
+    */
+    void* (*handler)(PyObject* roulette);
+
+} Roulette_CAPI;
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifndef ROULETTE_CAPI_MODULE
+
+static Roulette_CAPI* RouletteAPI = NULL;
+
+#define Roulette_IMPORT \
+    RouletteAPI = (Roulette_CAPI*)PyCapsule_Import(ROULETTE_CAPSULE_NAME, 0)
+
+#endif //ROULETTE_CAPI_MODULE
+
+#ifdef __cplusplus
+
+#include "python_smart_pointer.hpp"
+#include "roulette.hpp"
+
+/* what RouletteAPI->handler points to for a roulette of weight type W */
+template<typename W>
+using RouletteCapiHandler = Roulette<PythonSmartPointer, NewRand, W>;
+
+#endif //__cplusplus
+
+#endif //__ROULETTE_CAPI_H__
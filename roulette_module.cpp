@@ -1,9 +1,17 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 #include <utility>
+#include <cstdint>
+#include <new>
+#include <iterator>
+#include <string>
 
 #define ROULETTE_DEBUG_PYTHON
 #include "roulette.hpp"
+#include "shared_roulette.hpp"
+
+#define ROULETTE_CAPI_MODULE
+#include "roulette_capi.h"
 
 #define RLT_DEBUG
 
@@ -19,194 +27,447 @@
 
 #endif
 
-/********************************************************** python smart pointer **********************************************************/
+/********************************************************** type decleration **********************************************************/
 
-class PythonSmartPointer{
-private:
-    mutable PyObject* _py_object;
-    mutable std::string _obj_string;
-public:
+//--------------------------- PyRoulette ---------------------------//
 
-    PythonSmartPointer()
-    :_py_object(NULL)
-    { }
+template<typename W>
+using PyRouletteHandler = RouletteCapiHandler<W>;
 
-    PythonSmartPointer(PyObject* py_object)
-    :_py_object(py_object){
-        Py_INCREF(_py_object);
-    }
+typedef enum
+{
+    RLT_WEIGHT_DOUBLE = ROULETTE_WEIGHT_DOUBLE,
+    RLT_WEIGHT_FLOAT = ROULETTE_WEIGHT_FLOAT,
+    RLT_WEIGHT_UINT32 = ROULETTE_WEIGHT_UINT32,
+    RLT_WEIGHT_UINT64 = ROULETTE_WEIGHT_UINT64
 
-    PythonSmartPointer(const PythonSmartPointer& copy)
-    :_py_object(copy._py_object){
-        Py_INCREF(_py_object);
-    }
+}rlt_weight_kind;
 
-    PythonSmartPointer& operator=(const PythonSmartPointer& rhs){
+typedef struct 
+{
+    PyObject_HEAD
 
-        if(_py_object)
-            Py_XDECREF(_py_object);
-        _py_object = rhs._py_object;
-        Py_INCREF(_py_object);
-        return *this;
-    }
+    rlt_weight_kind weight_kind;
+    void* roulette_handler; // PyRouletteHandler<W>* matching weight_kind
+    Py_ssize_t exports;     // buffers exported through weights()/bounds(), the roulette cannot change while > 0
 
-    PythonSmartPointer& operator=(PyObject* rhs){
+}PyRoulette;
 
-        if(_py_object)
-            Py_XDECREF(_py_object);
-        _py_object = rhs;
-        Py_INCREF(_py_object);
-        return *this;
-    }
+static PyTypeObject RouletteType = { PyVarObject_HEAD_INIT(NULL, 0) };
+static PyMappingMethods RouletteTypeMappingMethods;
 
-    bool operator==(const PythonSmartPointer& other)const{
-        
-        if(!_py_object)
-            return false;
+static Py_ssize_t rlt_roulette_len(PyRoulette *self);
+static void rlt_roulette_dealloc(PyRoulette *self);
+static PyObject* rlt_roulette_new(PyTypeObject *type, PyObject *args, PyObject *kwds);
+static PyObject * rlt_roulette_insert(PyRoulette *self, PyObject *args);
+static int rlt_roulette_init(PyRoulette *self, PyObject *args, PyObject *kwds);
+static PyObject * rlt_roulette_roll(PyRoulette *self, PyObject *Py_UNUSED(ignored));
+static PyObject * rlt_roulette_remove(PyRoulette *self, PyObject *args);
+static PyObject* rlt_roulette_iterator(PyRoulette* self);
 
-        return PyObject_RichCompareBool(_py_object, other._py_object, Py_EQ);
-    }
+//--------------------------- PyRoulette ---------------------------//
 
-    bool operator!=(const PythonSmartPointer& other)const{
+//--------------------------- PyRouletteIterator ---------------------------//
 
-        if(!_py_object)
-            return true;
+typedef struct 
+{
+    PyObject_HEAD
 
-        return PyObject_RichCompareBool(_py_object, other._py_object, Py_NE);
-    }
+    PyRoulette* roulette; // strong reference, keeps the iterated roulette alive
+    Py_ssize_t index;
 
-    operator PyObject*() const{
-        return _py_object;
-    }
+}PyRouletteIterator;
 
-    PyObject* increase_ref() const{
-        
-        Py_INCREF(_py_object);
-        return _py_object;
+static PyTypeObject RouletteIteratorType = { PyVarObject_HEAD_INIT(NULL, 0) };
 
-    }
+static void rlt_roulette_iterator_dealloc(PyRouletteIterator *self);
+static PyObject* rlt_roulette_iterator_new(PyTypeObject *type, PyObject *args, PyObject *kwds);
+static int rlt_roulette_iterator_init(PyRouletteIterator *self, PyObject *args, PyObject *kwds);
+static PyObject* rlt_roulette_iterator_next (PyRouletteIterator * self);
 
-    operator std::string()const{
-        PyObject* objects_representation = PyObject_Str(_py_object);
+//--------------------------- PyRouletteIterator ---------------------------//
 
-        if(!objects_representation)
-            return "";
+//--------------------------- PyRouletteView ---------------------------//
 
-        const char* s = PyUnicode_AsUTF8(objects_representation);
+typedef enum
+{
+    RLT_VIEW_WEIGHTS,
+    RLT_VIEW_BOUNDS
 
-        if(!s)
-             _obj_string = "";
-        else
-            _obj_string = s;
+}rlt_view_field;
 
-        Py_DECREF(objects_representation);
+typedef struct 
+{
+    PyObject_HEAD
 
-        return _obj_string.c_str();
+    PyRoulette* roulette; // strong reference, keeps the viewed storage alive
+    rlt_view_field field;
+    Py_ssize_t shape[1];
+    Py_ssize_t strides[1];
 
-    }
+}PyRouletteView;
 
-    ~PythonSmartPointer(){
-        if(_py_object)
-            Py_XDECREF(_py_object);
-    }
+static PyTypeObject RouletteViewType = { PyVarObject_HEAD_INIT(NULL, 0) };
+static PyBufferProcs RouletteViewBufferProcs;
 
-};
+static PyObject* rlt_roulette_view_create(PyRoulette* roulette, rlt_view_field field);
 
-/********************************************************** python smart pointer **********************************************************/
+//--------------------------- PyRouletteView ---------------------------//
 
-/********************************************************** type decleration **********************************************************/
+//--------------------------- PyRouletteBank ---------------------------//
 
-//--------------------------- PyRoulette ---------------------------//
 typedef struct 
 {
     PyObject_HEAD
 
-    Roulette<PythonSmartPointer>* roulette_handler;
+    RouletteBank<PythonSmartPointer>* bank_handler;
 
-}PyRoulette;
+}PyRouletteBank;
 
-static PyTypeObject RouletteType = { PyVarObject_HEAD_INIT(NULL, 0) };
-static PyMappingMethods RouletteTypeMappingMethods;
+static PyTypeObject RouletteBankType = { PyVarObject_HEAD_INIT(NULL, 0) };
+static PyMappingMethods RouletteBankTypeMappingMethods;
 
-static Py_ssize_t rlt_roulette_len(PyRoulette *self);
-static void rlt_roulette_dealloc(PyRoulette *self);
-static PyObject* rlt_roulette_new(PyTypeObject *type, PyObject *args, PyObject *kwds);
-static PyObject * rlt_roulette_insert(PyRoulette *self, PyObject *args);
-static int rlt_roulette_init(PyRoulette *self, PyObject *args, PyObject *kwds);
-static PyObject * rlt_roulette_roll(PyRoulette *self, PyObject *Py_UNUSED(ignored));
-static PyObject * rlt_roulette_remove(PyRoulette *self, PyObject *args);
-static PyObject* rlt_roulette_iterator(PyRoulette* self);
+static PyObject * rlt_roulette_bank_add(PyRouletteBank *self, PyObject *args);
 
-//--------------------------- PyRoulette ---------------------------//
+//--------------------------- PyRouletteBank ---------------------------//
 
-//--------------------------- PyRouletteIterator ---------------------------//
+//--------------------------- PyRouletteMixture ---------------------------//
+
+/* components may use different weight types, so the mixture only picks the component and lets it roll */
+struct rlt_mixture_state{
+    std::vector<PyRoulette*> components; // strong references
+    std::vector<double> weights;
+    AliasTable table;
+    NewRand rand_gen;
+};
 
 typedef struct 
 {
     PyObject_HEAD
 
-    Roulette<PythonSmartPointer>::iterator* begin_iterator;
-    Roulette<PythonSmartPointer>::iterator* end_iterator;
+    rlt_mixture_state* mixture_handler;
 
-}PyRouletteIterator;
+}PyRouletteMixture;
 
-static PyTypeObject RouletteIteratorType = { PyVarObject_HEAD_INIT(NULL, 0) };
+static PyTypeObject RouletteMixtureType = { PyVarObject_HEAD_INIT(NULL, 0) };
+static PyMappingMethods RouletteMixtureTypeMappingMethods;
 
-static void rlt_roulette_iterator_dealloc(PyRouletteIterator *self);
-static PyObject* rlt_roulette_iterator_new(PyTypeObject *type, PyObject *args, PyObject *kwds);
-static int rlt_roulette_iterator_init(PyRouletteIterator *self, PyObject *args, PyObject *kwds);
-static PyObject* rlt_roulette_iterator_next (PyRouletteIterator * self);
+static PyObject * rlt_roulette_mixture_add(PyRouletteMixture *self, PyObject *args);
 
-//--------------------------- PyRouletteIterator ---------------------------//
+//--------------------------- PyRouletteMixture ---------------------------//
+
+//--------------------------- PySharedRoulette ---------------------------//
+
+#ifdef ROULETTE_HAS_SHARED_MEMORY
+
+typedef struct 
+{
+    PyObject_HEAD
+
+    SharedRoulette<>* shared_handler;
+
+}PySharedRoulette;
+
+static PyTypeObject SharedRouletteType = { PyVarObject_HEAD_INIT(NULL, 0) };
+static PyMappingMethods SharedRouletteTypeMappingMethods;
+
+#endif
+
+//--------------------------- PySharedRoulette ---------------------------//
 
 /********************************************************** type decleration **********************************************************/
 
 /********************************************************** roulette type **********************************************************/
 
+/********************************************************** weight helpers **********************************************************/
+
+/* calls func with the roulette handler cast to its real weight type */
+template<typename FUNC>
+static auto rlt_roulette_visit(PyRoulette* self, FUNC&& func) -> decltype(func((PyRouletteHandler<double>*)NULL)){
+
+    switch(self->weight_kind){
+        case RLT_WEIGHT_FLOAT:
+            return func((PyRouletteHandler<float>*)self->roulette_handler);
+        case RLT_WEIGHT_UINT32:
+            return func((PyRouletteHandler<uint32_t>*)self->roulette_handler);
+        case RLT_WEIGHT_UINT64:
+            return func((PyRouletteHandler<uint64_t>*)self->roulette_handler);
+        case RLT_WEIGHT_DOUBLE:
+        default:
+            return func((PyRouletteHandler<double>*)self->roulette_handler);
+    }
+}
+
+template<typename HANDLER>
+using rlt_weight_t = typename std::remove_pointer<HANDLER>::type::weight_type;
+
+static const char* rlt_weight_kind_name(rlt_weight_kind kind){
+
+    switch(kind){
+        case RLT_WEIGHT_FLOAT:  return "float";
+        case RLT_WEIGHT_UINT32: return "uint32";
+        case RLT_WEIGHT_UINT64: return "uint64";
+        case RLT_WEIGHT_DOUBLE:
+        default:                return "double";
+    }
+}
+
+static bool rlt_weight_kind_from_name(const char* name, rlt_weight_kind* kind){
+
+    static const rlt_weight_kind kinds[] = {RLT_WEIGHT_DOUBLE, RLT_WEIGHT_FLOAT, RLT_WEIGHT_UINT32, RLT_WEIGHT_UINT64};
+
+    for(rlt_weight_kind candidate : kinds){
+        if(!strcmp(name, rlt_weight_kind_name(candidate))){
+            *kind = candidate;
+            return true;
+        }
+    }
+
+    PyErr_Format(PyExc_ValueError, "unknown weight_type \"%s\", expecting double, float, uint32 or uint64", name);
+    return false;
+}
+
+static bool rlt_weight_from_py(PyObject* object, double* weight){
+    *weight = PyFloat_AsDouble(object);
+    return !PyErr_Occurred();
+}
+
+static bool rlt_weight_from_py(PyObject* object, float* weight){
+    double temp = PyFloat_AsDouble(object);
+    *weight = (float)temp;
+    return !PyErr_Occurred();
+}
+
+static bool rlt_weight_from_py(PyObject* object, uint64_t* weight){
+    unsigned long long temp = PyLong_AsUnsignedLongLong(object);
+
+    if(PyErr_Occurred())
+        return false;
+
+    *weight = (uint64_t)temp;
+    return true;
+}
+
+static bool rlt_weight_from_py(PyObject* object, uint32_t* weight){
+    uint64_t temp;
+
+    if(!rlt_weight_from_py(object, &temp))
+        return false;
+
+    if(temp > 0xFFFFFFFFULL){
+        PyErr_Format(PyExc_OverflowError, "chance does not fit in a uint32 weight");
+        return false;
+    }
+
+    *weight = (uint32_t)temp;
+    return true;
+}
+
+static PyObject* rlt_weight_to_py(double weight){ return PyFloat_FromDouble(weight); }
+static PyObject* rlt_weight_to_py(float weight){ return PyFloat_FromDouble(weight); }
+static PyObject* rlt_weight_to_py(uint32_t weight){ return PyLong_FromUnsignedLong(weight); }
+static PyObject* rlt_weight_to_py(uint64_t weight){ return PyLong_FromUnsignedLongLong(weight); }
+
+static const char* rlt_weight_format(double*){ return "d"; }
+static const char* rlt_weight_format(float*){ return "f"; }
+static const char* rlt_weight_format(uint32_t*){ return "I"; }
+static const char* rlt_weight_format(uint64_t*){ return "Q"; }
+
+/* translates a c++ exception thrown by the roulette into a python exception */
+static void rlt_set_exception(const std::exception& exception){
+
+    if(auto system_error = dynamic_cast<const std::system_error*>(&exception)){
+        errno = system_error->code().value();
+        PyErr_SetFromErrno(PyExc_OSError);
+    }
+    else if(dynamic_cast<const std::invalid_argument*>(&exception))
+        PyErr_SetString(PyExc_ValueError, exception.what());
+    else if(dynamic_cast<const std::out_of_range*>(&exception))
+        PyErr_SetString(PyExc_IndexError, exception.what());
+    else if(dynamic_cast<const std::overflow_error*>(&exception))
+        PyErr_SetString(PyExc_OverflowError, exception.what());
+    else
+        PyErr_SetString(PyExc_RuntimeError, exception.what());
+}
+
+/* hash of a key for roll_for, int, str and bytes hash like their c++ counterparts so assignments match across languages */
+static bool rlt_key_hash(PyObject* key, uint64_t* hash){
+
+    if(PyLong_Check(key)){
+        unsigned long long value = PyLong_AsUnsignedLongLongMask(key);
+
+        if(value == (unsigned long long)-1 && PyErr_Occurred())
+            return false;
+
+        *hash = roulette_key_hash((uint64_t)value);
+        return true;
+    }
+
+    if(PyBytes_Check(key)){
+        *hash = roulette_key_hash(PyBytes_AS_STRING(key), (size_t)PyBytes_GET_SIZE(key));
+        return true;
+    }
+
+    if(PyUnicode_Check(key)){
+        Py_ssize_t length;
+        const char* utf8 = PyUnicode_AsUTF8AndSize(key, &length);
+
+        if(!utf8)
+            return false;
+
+        *hash = roulette_key_hash(utf8, (size_t)length);
+        return true;
+    }
+
+    PyErr_Format(PyExc_TypeError, "keys must be int, str or bytes, not %.200s", Py_TYPE(key)->tp_name);
+    return false;
+}
+
+/* hashes every item of a 1-d buffer of native integers, fails with TypeError for any other layout */
+static bool rlt_buffer_key_hashes(Py_buffer* buffer, std::vector<uint64_t>& hashes){
+
+    const char* format = buffer->format ? buffer->format : "B";
+
+    if(*format == '@')
+        ++format;
+
+    bool is_signed = format[0] && !format[1] && strchr("bhilqn", format[0]);
+    bool is_unsigned = format[0] && !format[1] && strchr("BHILQN", format[0]);
+
+    if(buffer->ndim != 1 || (!is_signed && !is_unsigned) || (buffer->itemsize != 1 && buffer->itemsize != 2 && buffer->itemsize != 4 && buffer->itemsize != 8)){
+        PyErr_Format(PyExc_TypeError, "keys buffer must be one dimensional and hold native integers");
+        return false;
+    }
+
+    Py_ssize_t count = buffer->len / buffer->itemsize;
+    char const* item = (char const*)buffer->buf;
+
+    hashes.reserve(count);
+
+    for(Py_ssize_t i = 0 ; i < count ; ++i, item += buffer->itemsize){
+        uint64_t word = 0;
+
+        switch(buffer->itemsize){
+            case 1: word = is_signed ? (uint64_t)*(int8_t const*)item : *(uint8_t const*)item; break;
+            case 2: { int16_t v; memcpy(&v, item, 2); word = is_signed ? (uint64_t)v : (uint16_t)v; break; }
+            case 4: { int32_t v; memcpy(&v, item, 4); word = is_signed ? (uint64_t)v : (uint32_t)v; break; }
+            default: memcpy(&word, item, 8); break;
+        }
+
+        hashes.push_back(roulette_key_hash(word));
+    }
+
+    return true;
+}
+
+/********************************************************** weight helpers **********************************************************/
+
+/********************************************************** roulette type **********************************************************/
+
 static void rlt_roulette_dealloc(PyRoulette *self)
 {
-    self->roulette_handler->~Roulette();
-    PyMem_RawFree(self->roulette_handler);
+    if(self->roulette_handler){
+        rlt_roulette_visit(self, [](auto* roulette){
+            typedef typename std::remove_pointer<decltype(roulette)>::type handler_t;
+            roulette->~handler_t();
+        });
+        PyMem_RawFree(self->roulette_handler);
+    }
     Py_TYPE(self)->tp_free((PyObject *) self);
 }
 
+template<typename W>
+static void* rlt_roulette_handler_new(){
+
+    void* temp_ptr = PyMem_RawMalloc(sizeof(PyRouletteHandler<W>));
+
+    if(!temp_ptr)
+        return NULL;
+
+    return new(temp_ptr) PyRouletteHandler<W>();
+}
 
 static PyObject* rlt_roulette_new(PyTypeObject *type, PyObject *args, PyObject *kwds){
+    static char chance_list_str[] = "chance_list";
+    static char weight_type_str[] = "weight_type";
+    static char *kwlist[] = {chance_list_str, weight_type_str, NULL};
+    PyObject* chance_list = NULL;
+    const char* weight_type = NULL;
+    rlt_weight_kind weight_kind = RLT_WEIGHT_DOUBLE;
+    void* temp_ptr = NULL;
 
     PyRoulette *self;
 
-    void* temp_ptr = PyMem_RawMalloc(sizeof(Roulette<PythonSmartPointer>));
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|Os", kwlist, &chance_list, &weight_type))
+        return NULL;
 
-    if(!temp_ptr)
+    if(weight_type && !rlt_weight_kind_from_name(weight_type, &weight_kind))
         return NULL;
 
-    if(!(self = (PyRoulette *) type->tp_alloc(type, 0))){
-        PyMem_RawFree(temp_ptr);
+    if(!(self = (PyRoulette *) type->tp_alloc(type, 0)))
         return NULL;
+
+    switch(weight_kind){
+        case RLT_WEIGHT_FLOAT:  temp_ptr = rlt_roulette_handler_new<float>(); break;
+        case RLT_WEIGHT_UINT32: temp_ptr = rlt_roulette_handler_new<uint32_t>(); break;
+        case RLT_WEIGHT_UINT64: temp_ptr = rlt_roulette_handler_new<uint64_t>(); break;
+        case RLT_WEIGHT_DOUBLE: temp_ptr = rlt_roulette_handler_new<double>(); break;
+    }
+
+    self->weight_kind = weight_kind;
+    self->roulette_handler = temp_ptr;
+    self->exports = 0;
+
+    if(!temp_ptr){
+        Py_DECREF(self);
+        return PyErr_NoMemory();
     }
-    
-    self->roulette_handler = new(temp_ptr) Roulette<PythonSmartPointer>();
 
     return (PyObject *)self;
 }
 
+/* fails with BufferError while weights()/bounds() views are alive or roll_many() runs without the GIL */
+static bool rlt_roulette_check_mutable(PyRoulette *self){
+
+    if(self->exports > 0){
+        PyErr_Format(PyExc_BufferError, "roulette cannot be modified while weight or bound views are exported or roll_many is running");
+        return false;
+    }
+
+    return true;
+}
+
 static PyObject * rlt_roulette_insert(PyRoulette *self, PyObject *args)
 {
-    PyObject* object;
-    double chance;
+    PyObject* object, *py_chance;
 
-    if(!PyArg_ParseTuple(args, "Od", &object, &chance)) {
+    if(!PyArg_ParseTuple(args, "OO", &object, &py_chance)) {
         return NULL;
     }
 
-    self->roulette_handler->insert(object, chance);
+    if(!rlt_roulette_check_mutable(self))
+        return NULL;
 
-    Py_RETURN_NONE;
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        rlt_weight_t<decltype(roulette)> chance;
+
+        if(!rlt_weight_from_py(py_chance, &chance))
+            return NULL;
+
+        try{
+            roulette->insert(object, chance);
+        }catch(const std::exception& exception){
+            rlt_set_exception(exception);
+            return NULL;
+        }
+
+        Py_RETURN_NONE;
+    });
 }
 
 static PyObject * rlt_roulette_insert_list(PyRoulette *self, PyObject *args)
 {
-    PyObject* chance_list = NULL, *iterator = NULL, *item = NULL;
+    PyObject* chance_list = NULL, *iterator = NULL, *item = NULL, *none_obj = NULL;
 
     if(!PyArg_ParseTuple(args, "O", &chance_list)) {
         return NULL;
@@ -225,27 +486,33 @@ static PyObject * rlt_roulette_insert_list(PyRoulette *self, PyObject *args)
             return NULL;
         }
 
-        if(!rlt_roulette_insert(self, item)) {
+        if(!(none_obj = rlt_roulette_insert(self, item))) {
             Py_DECREF(item);
             Py_DECREF(iterator);
             return NULL;
         }
 
+        Py_DECREF(none_obj);
         Py_DECREF(item);
     }
 
     Py_DECREF(iterator);
 
+    if (PyErr_Occurred())
+        return NULL;
+
     Py_RETURN_NONE;
 }
 
 static int rlt_roulette_init(PyRoulette *self, PyObject *args, PyObject *kwds){
     static char chance_list_str[] = "chance_list";
-    static char *kwlist[] = {chance_list_str, NULL};
+    static char weight_type_str[] = "weight_type";
+    static char *kwlist[] = {chance_list_str, weight_type_str, NULL};
     PyObject* chance_list = NULL, *iterator = NULL, *item = NULL, *none_obj = NULL;
+    const char* weight_type = NULL; // consumed by rlt_roulette_new
 
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O", kwlist, &chance_list))
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|Os", kwlist, &chance_list, &weight_type))
         return -1;
 
     if(chance_list){
@@ -283,274 +550,1781 @@ static int rlt_roulette_init(PyRoulette *self, PyObject *args, PyObject *kwds){
 }   
 
 static Py_ssize_t rlt_roulette_len(PyRoulette *self){
-    return self->roulette_handler->size();
+    return rlt_roulette_visit(self, [](auto* roulette) -> Py_ssize_t {
+        return roulette->size();
+    });
 }
 
 static PyObject* rlt_roulette_get_item(PyRoulette *self, PyObject *key){
 
     PythonSmartPointer ptr(key);
 
-    auto iter = self->roulette_handler->find(ptr);
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        size_t index = roulette->index_of(ptr);
 
-    if(iter == self->roulette_handler->end()){
-        PyErr_Format(PyExc_KeyError, "key not found");
-        return NULL;
-    }
+        if(index == roulette->slot_count()){
+            PyErr_Format(PyExc_KeyError, "key not found");
+            return NULL;
+        }
 
-    return PyFloat_FromDouble(iter->get_range());
+        return rlt_weight_to_py(roulette->get_weight(index));
+    });
 }
 
 static int rlt_roulette_set_item(PyRoulette *self, PyObject *key, PyObject *value){
     
-    double new_chance;
     PythonSmartPointer ptr(key);
 
-    if(NULL == value){ //remove
-        if(!self->roulette_handler->remove(ptr)){
-            PyErr_Format(PyExc_KeyError, "key not found");
-            return -1;
-        }
-    }else{ //update
-        new_chance = PyFloat_AsDouble(value);
+    if(!rlt_roulette_check_mutable(self))
+        return -1;
 
-        if(PyErr_Occurred())
-            return -1;
+    return rlt_roulette_visit(self, [&](auto* roulette) -> int {
+        rlt_weight_t<decltype(roulette)> new_chance;
 
-        if(!self->roulette_handler->update(ptr, new_chance)){
-            PyErr_Format(PyExc_KeyError, "key not found");
-            return -1;
+        if(NULL == value){ //remove
+            if(!roulette->remove(ptr)){
+                PyErr_Format(PyExc_KeyError, "key not found");
+                return -1;
+            }
+        }else{ //update
+            if(!rlt_weight_from_py(value, &new_chance))
+                return -1;
+
+            try{
+                if(!roulette->update(ptr, new_chance)){
+                    PyErr_Format(PyExc_KeyError, "key not found");
+                    return -1;
+                }
+            }catch(const std::exception& exception){
+                rlt_set_exception(exception);
+                return -1;
+            }
         }
-    }
-    return 0;
+        return 0;
+    });
 }
 
 static PyObject * rlt_roulette_roll(PyRoulette *self, PyObject *Py_UNUSED(ignored))
 {   
-    PythonSmartPointer ret_val;
-    try{
-         ret_val = self->roulette_handler->roll();
-    }catch(...){
-        RLT_PRINT_LINE("an exception was thrown");
-        return NULL;
-    }
-    return ret_val.increase_ref();
+    return rlt_roulette_visit(self, [](auto* roulette) -> PyObject* {
+        PythonSmartPointer ret_val;
+
+        if(roulette->is_empty()){
+            PyErr_Format(PyExc_IndexError, "cannot roll an empty roulette");
+            return NULL;
+        }
+
+        try{
+             ret_val = roulette->roll();
+        }catch(const std::exception& exception){
+            RLT_PRINT_LINE("an exception was thrown");
+            rlt_set_exception(exception);
+            return NULL;
+        }
+        return ret_val.increase_ref();
+    });
 }
 
-static PyObject * rlt_roulette_remove(PyRoulette *self, PyObject *args)
+static PyObject * rlt_roulette_roll_range(PyRoulette *self, PyObject *args)
 {
-    PyObject* object;
+    Py_ssize_t first, last;
 
-    if(!PyArg_ParseTuple(args, "O", &object)) {
+    if(!PyArg_ParseTuple(args, "nn", &first, &last)) {
         return NULL;
     }
 
-    PythonSmartPointer ptr(object);
-    
-    if(self->roulette_handler->remove(ptr))
-        Py_RETURN_TRUE;
+    if(first < 0 || last < 0){
+        PyErr_Format(PyExc_IndexError, "invalid entry range");
+        return NULL;
+    }
 
-    Py_RETURN_FALSE;
-}
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        PythonSmartPointer ret_val;
 
-static PyObject* rlt_roulette_update(PyRoulette *self, PyObject *args){
+        try{
+             ret_val = roulette->roll_range((size_t)first, (size_t)last);
+        }catch(const std::exception& exception){
+            rlt_set_exception(exception);
+            return NULL;
+        }
+        return ret_val.increase_ref();
+    });
+}
 
-    PyObject* object;
-    double new_chance;
+/* roll_for(key), the element key is assigned to, the same while the roulette does not change */
+static PyObject * rlt_roulette_roll_for(PyRoulette *self, PyObject *args)
+{
+    PyObject* key;
+    uint64_t hash;
 
-    if(!PyArg_ParseTuple(args, "Od", &object, &new_chance)) {
+    if(!PyArg_ParseTuple(args, "O", &key)) {
         return NULL;
     }
 
-    PythonSmartPointer ptr(object);
+    if(!rlt_key_hash(key, &hash))
+        return NULL;
 
-    if(self->roulette_handler->update(ptr, new_chance))
-        Py_RETURN_TRUE;
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        size_t index;
 
-    Py_RETURN_FALSE;
-}
+        if(roulette->is_empty()){
+            PyErr_Format(PyExc_IndexError, "cannot roll an empty roulette");
+            return NULL;
+        }
 
-static PyObject* rlt_roulette_iterator(PyRoulette* self){
+        try{
+            index = roulette->roll_index_for_hash(hash);
+        }catch(const std::exception& exception){
+            rlt_set_exception(exception);
+            return NULL;
+        }
 
-    PyObject *args = NULL, *kwds = NULL, *iter = NULL;
-    bool complete = false;
+        return roulette->at(index).get_value().increase_ref();
+    });
+}
 
-    do{
-        if( !(args = Py_BuildValue("(O)", self)))
-            break;
+/* roll_for_many(keys), roll_for over a buffer of integers (e.g. array('q') or a numpy array) or any iterable of keys */
+static PyObject * rlt_roulette_roll_for_many(PyRoulette *self, PyObject *args)
+{
+    PyObject* keys, *iterator = NULL, *item = NULL;
+    std::vector<uint64_t> hashes;
 
-        if( !(kwds = Py_BuildValue("{}")))
-            break;
+    if(!PyArg_ParseTuple(args, "O", &keys)) {
+        return NULL;
+    }
 
-        if(!(iter = rlt_roulette_iterator_new(&RouletteIteratorType, NULL, NULL)))
-            break;
+    if(PyObject_CheckBuffer(keys)){
+        Py_buffer buffer;
 
-        if(rlt_roulette_iterator_init((PyRouletteIterator*)iter, args, kwds) < 0)
-            break;
+        if(PyObject_GetBuffer(keys, &buffer, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0)
+            return NULL;
 
-        complete = true;
+        bool hashed = rlt_buffer_key_hashes(&buffer, hashes);
+        PyBuffer_Release(&buffer);
+
+        if(!hashed)
+            return NULL;
+    }else{
+        if(!(iterator = PyObject_GetIter(keys)))
+            return NULL;
+
+        while((item = PyIter_Next(iterator))){
+            uint64_t hash;
+            bool hashed = rlt_key_hash(item, &hash);
+            Py_DECREF(item);
+
+            if(!hashed){
+                Py_DECREF(iterator);
+                return NULL;
+            }
+
+            hashes.push_back(hash);
+        }
+
+        Py_DECREF(iterator);
+
+        if(PyErr_Occurred())
+            return NULL;
+    }
+
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        PyObject* result = NULL;
+        Py_ssize_t n = (Py_ssize_t)hashes.size();
+
+        if(n && roulette->is_empty()){
+            PyErr_Format(PyExc_IndexError, "cannot roll an empty roulette");
+            return NULL;
+        }
+
+        if(!(result = PyList_New(n)))
+            return NULL;
+
+        try{
+            for(Py_ssize_t i = 0 ; i < n ; ++i)
+                PyList_SET_ITEM(result, i, roulette->at(roulette->roll_index_for_hash(hashes[i])).get_value().increase_ref());
+        }catch(const std::exception& exception){
+            Py_DECREF(result);
+            rlt_set_exception(exception);
+            return NULL;
+        }
+
+        return result;
+    });
+}
+
+/* roll_many(n, threads=0), n independent draws computed by several threads with the GIL released */
+static PyObject * rlt_roulette_roll_many(PyRoulette *self, PyObject *args, PyObject *kwds)
+{
+    static char n_str[] = "n";
+    static char threads_str[] = "threads";
+    static char *kwlist[] = {n_str, threads_str, NULL};
+    Py_ssize_t n, threads = 0;
+    std::vector<size_t> indices;
+
+    if(!PyArg_ParseTupleAndKeywords(args, kwds, "n|n", kwlist, &n, &threads)) {
+        return NULL;
+    }
+
+    if(n < 0 || threads < 0){
+        PyErr_Format(PyExc_ValueError, "n and threads cannot be negative");
+        return NULL;
+    }
+
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        PyObject* result = NULL;
+        std::exception_ptr error;
+
+        if(n && roulette->is_empty()){
+            PyErr_Format(PyExc_IndexError, "cannot roll an empty roulette");
+            return NULL;
+        }
+
+        try{
+            indices.resize(n);
+        }catch(const std::exception& exception){
+            rlt_set_exception(exception);
+            return NULL;
+        }
+
+        //search caches are only rebuilt by non-const calls, have them ready for the workers
+        roulette->sync_skew_search();
+
+        //the roulette generator is shared with every other caller, only touch it while the GIL is held
+        uint64_t seed = roulette->draw_seed();
+
+        //other threads may run python meanwhile, keep them from changing the table like a live view does
+        ++self->exports;
+
+        Py_BEGIN_ALLOW_THREADS
+        try{
+            roulette->roll_parallel((size_t)n, indices.data(), (size_t)threads, seed);
+        }catch(...){
+            error = std::current_exception();
+        }
+        Py_END_ALLOW_THREADS
+
+        --self->exports;
+
+        if(error){
+            try{
+                std::rethrow_exception(error);
+            }catch(const std::exception& exception){
+                rlt_set_exception(exception);
+                return NULL;
+            }
+        }
+
+        if(!(result = PyList_New(n)))
+            return NULL;
+
+        try{
+            for(Py_ssize_t i = 0 ; i < n ; ++i)
+                PyList_SET_ITEM(result, i, roulette->at(indices[i]).get_value().increase_ref());
+        }catch(const std::exception& exception){
+            Py_DECREF(result);
+            rlt_set_exception(exception);
+            return NULL;
+        }
+
+        return result;
+    });
+}
+
+/* resample(n, method='multinomial'), n draws in one sorted sweep over the table */
+static PyObject * rlt_roulette_resample(PyRoulette *self, PyObject *args, PyObject *kwds)
+{
+    static char n_str[] = "n";
+    static char method_str[] = "method";
+    static char *kwlist[] = {n_str, method_str, NULL};
+    static const char* method_names[] = {"multinomial", "systematic", "stratified", "residual"};
+    static const resample_method methods[] = {RESAMPLE_MULTINOMIAL, RESAMPLE_SYSTEMATIC, RESAMPLE_STRATIFIED, RESAMPLE_RESIDUAL};
+    Py_ssize_t n;
+    const char* method_name = "multinomial";
+    int method = -1;
+    std::vector<size_t> indices;
+
+    if(!PyArg_ParseTupleAndKeywords(args, kwds, "n|s", kwlist, &n, &method_name)) {
+        return NULL;
+    }
+
+    for(int i = 0 ; i < 4 ; ++i)
+        if(!strcmp(method_name, method_names[i]))
+            method = i;
+
+    if(method < 0){
+        PyErr_Format(PyExc_ValueError, "unknown method \"%s\", expecting multinomial, systematic, stratified or residual", method_name);
+        return NULL;
+    }
+
+    resample_method chosen = methods[method];
+
+    if(n < 0){
+        PyErr_Format(PyExc_ValueError, "n cannot be negative");
+        return NULL;
+    }
+
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        PyObject* result = NULL;
+
+        if(n && roulette->is_empty()){
+            PyErr_Format(PyExc_IndexError, "cannot resample an empty roulette");
+            return NULL;
+        }
+
+        try{
+            indices.reserve(n);
+            roulette->resample((size_t)n, std::back_inserter(indices), chosen);
+        }catch(const std::exception& exception){
+            rlt_set_exception(exception);
+            return NULL;
+        }
+
+        if(!(result = PyList_New(n)))
+            return NULL;
+
+        for(Py_ssize_t i = 0 ; i < n ; ++i)
+            PyList_SET_ITEM(result, i, roulette->at(indices[i]).get_value().increase_ref());
+
+        return result;
+    });
+}
+
+static PyObject * rlt_roulette_set_prefetch(PyRoulette *self, PyObject *args, PyObject *kwds)
+{
+    static char depth_str[] = "depth";
+    static char refill_threshold_str[] = "refill_threshold";
+    static char *kwlist[] = {depth_str, refill_threshold_str, NULL};
+    Py_ssize_t depth, refill_threshold = 0;
+
+    if(!PyArg_ParseTupleAndKeywords(args, kwds, "n|n", kwlist, &depth, &refill_threshold)) {
+        return NULL;
+    }
+
+    if(depth < 0 || refill_threshold < 0){
+        PyErr_Format(PyExc_ValueError, "depth and refill_threshold cannot be negative");
+        return NULL;
+    }
+
+    if(!rlt_roulette_check_mutable(self))
+        return NULL;
+
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        try{
+            roulette->set_prefetch((size_t)depth, (size_t)refill_threshold);
+        }catch(const std::exception& exception){
+            rlt_set_exception(exception);
+            return NULL;
+        }
+
+        Py_RETURN_NONE;
+    });
+}
+
+/* rolls as if the entries at the given slots had no weight, python error already set on failure */
+static PyObject * rlt_roulette_roll_without(PyRoulette *self, std::vector<size_t> const& excluded)
+{
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        PythonSmartPointer ret_val;
+
+        try{
+             ret_val = roulette->roll_excluding(excluded);
+        }catch(const std::exception& exception){
+            rlt_set_exception(exception);
+            return NULL;
+        }
+        return ret_val.increase_ref();
+    });
+}
+
+/* rolls as if the given keys were not in the roulette, keys that are not in it are ignored */
+static PyObject * rlt_roulette_roll_excluding(PyRoulette *self, PyObject *args)
+{
+    PyObject* keys = NULL, *iterator = NULL, *item = NULL;
+    std::vector<size_t> excluded;
+
+    if(!PyArg_ParseTuple(args, "O", &keys)) {
+        return NULL;
+    }
+
+    if(!(iterator = PyObject_GetIter(keys))){
+        return NULL;
+    }
+
+    //every key is a linear scan of the table, O(k * n) comparisons, index() and roll_excluding_indices avoid it
+    while ((item = PyIter_Next(iterator)))
+    {
+        PythonSmartPointer ptr(item);
+        Py_DECREF(item);
+
+        rlt_roulette_visit(self, [&](auto* roulette){
+            size_t index = roulette->index_of(ptr);
+
+            if(index < roulette->slot_count())
+                excluded.push_back(index);
+        });
+    }
+
+    Py_DECREF(iterator);
+
+    if (PyErr_Occurred())
+        return NULL;
+
+    return rlt_roulette_roll_without(self, excluded);
+}
+
+static PyObject * rlt_roulette_roll_excluding_indices(PyRoulette *self, PyObject *args)
+{
+    PyObject* indices = NULL, *iterator = NULL, *item = NULL;
+    std::vector<size_t> excluded;
+
+    if(!PyArg_ParseTuple(args, "O", &indices)) {
+        return NULL;
+    }
+
+    if(!(iterator = PyObject_GetIter(indices))){
+        return NULL;
+    }
+
+    while ((item = PyIter_Next(iterator)))
+    {
+        Py_ssize_t index = PyNumber_AsSsize_t(item, PyExc_IndexError);
+        Py_DECREF(item);
+
+        if(index == -1 && PyErr_Occurred())
+            break;
+
+        if(index < 0){
+            PyErr_Format(PyExc_IndexError, "excluded index out of range");
+            break;
+        }
+
+        excluded.push_back((size_t)index);
+    }
+
+    Py_DECREF(iterator);
+
+    if (PyErr_Occurred())
+        return NULL;
+
+    return rlt_roulette_roll_without(self, excluded);
+}
+
+static PyObject * rlt_roulette_index(PyRoulette *self, PyObject *args)
+{
+    PyObject* key = NULL;
+
+    if(!PyArg_ParseTuple(args, "O", &key)) {
+        return NULL;
+    }
+
+    PythonSmartPointer ptr(key);
+
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        size_t index = roulette->index_of(ptr);
+
+        if(index == roulette->slot_count()){
+            PyErr_Format(PyExc_KeyError, "key not found");
+            return NULL;
+        }
+
+        return PyLong_FromSize_t(index);
+    });
+}
+
+static PyObject * rlt_roulette_remove(PyRoulette *self, PyObject *args)
+{
+    PyObject* object;
+
+    if(!PyArg_ParseTuple(args, "O", &object)) {
+        return NULL;
+    }
+
+    if(!rlt_roulette_check_mutable(self))
+        return NULL;
+
+    PythonSmartPointer ptr(object);
+    
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        if(roulette->remove(ptr))
+            Py_RETURN_TRUE;
+
+        Py_RETURN_FALSE;
+    });
+}
+
+static PyObject* rlt_roulette_update(PyRoulette *self, PyObject *args){
+
+    PyObject* object, *py_chance;
+
+    if(!PyArg_ParseTuple(args, "OO", &object, &py_chance)) {
+        return NULL;
+    }
+
+    if(!rlt_roulette_check_mutable(self))
+        return NULL;
+
+    PythonSmartPointer ptr(object);
+
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        rlt_weight_t<decltype(roulette)> new_chance;
+
+        if(!rlt_weight_from_py(py_chance, &new_chance))
+            return NULL;
+
+        try{
+            if(roulette->update(ptr, new_chance))
+                Py_RETURN_TRUE;
+        }catch(const std::exception& exception){
+            rlt_set_exception(exception);
+            return NULL;
+        }
+
+        Py_RETURN_FALSE;
+    });
+}
+
+static PyObject * rlt_roulette_scale_all(PyRoulette *self, PyObject *args)
+{
+    double factor;
+
+    if(!PyArg_ParseTuple(args, "d", &factor)) {
+        return NULL;
+    }
+
+    if(self->weight_kind == RLT_WEIGHT_UINT32 || self->weight_kind == RLT_WEIGHT_UINT64){
+        PyErr_Format(PyExc_TypeError, "scale_all needs a double or float weight_type");
+        return NULL;
+    }
+
+    if(!rlt_roulette_check_mutable(self))
+        return NULL;
+
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        try{
+            roulette->scale_all(factor);
+        }catch(const std::exception& exception){
+            rlt_set_exception(exception);
+            return NULL;
+        }
+
+        Py_RETURN_NONE;
+    });
+}
+
+static PyObject * rlt_roulette_add(PyRoulette *self, PyObject *args)
+{
+    PyObject* object, *py_delta;
+
+    if(!PyArg_ParseTuple(args, "OO", &object, &py_delta)) {
+        return NULL;
+    }
+
+    if(!rlt_roulette_check_mutable(self))
+        return NULL;
+
+    PythonSmartPointer ptr(object);
+
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        rlt_weight_t<decltype(roulette)> delta;
+
+        if(!rlt_weight_from_py(py_delta, &delta))
+            return NULL;
+
+        try{
+            roulette->add(ptr, delta);
+        }catch(const std::exception& exception){
+            rlt_set_exception(exception);
+            return NULL;
+        }
+
+        Py_RETURN_NONE;
+    });
+}
+
+static PyObject * rlt_roulette_set_lazy_removal(PyRoulette *self, PyObject *args)
+{
+    double compaction_ratio;
+
+    if(!PyArg_ParseTuple(args, "d", &compaction_ratio)) {
+        return NULL;
+    }
+
+    if(!rlt_roulette_check_mutable(self))
+        return NULL;
+
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        try{
+            roulette->set_lazy_removal(compaction_ratio);
+        }catch(const std::exception& exception){
+            rlt_set_exception(exception);
+            return NULL;
+        }
+
+        Py_RETURN_NONE;
+    });
+}
+
+static PyObject * rlt_roulette_set_skew_search(PyRoulette *self, PyObject *args)
+{
+    int enable;
+
+    if(!PyArg_ParseTuple(args, "p", &enable)) {
+        return NULL;
+    }
+
+    if(!rlt_roulette_check_mutable(self))
+        return NULL;
+
+    return rlt_roulette_visit(self, [&](auto* roulette) -> PyObject* {
+        try{
+            roulette->set_skew_search(enable);
+        }catch(const std::exception& exception){
+            rlt_set_exception(exception);
+            return NULL;
+        }
+
+        Py_RETURN_NONE;
+    });
+}
+
+static PyObject * rlt_roulette_compact(PyRoulette *self, PyObject *Py_UNUSED(ignored))
+{
+    if(!rlt_roulette_check_mutable(self))
+        return NULL;
+
+    rlt_roulette_visit(self, [](auto* roulette){
+        roulette->compact();
+    });
+
+    Py_RETURN_NONE;
+}
+
+static PyObject* rlt_roulette_weights(PyRoulette *self, PyObject *Py_UNUSED(ignored)){
+    return rlt_roulette_view_create(self, RLT_VIEW_WEIGHTS);
+}
+
+static PyObject* rlt_roulette_bounds(PyRoulette *self, PyObject *Py_UNUSED(ignored)){
+    return rlt_roulette_view_create(self, RLT_VIEW_BOUNDS);
+}
+
+static PyObject* rlt_roulette_get_weight_type(PyRoulette *self, void *Py_UNUSED(closure)){
+    return PyUnicode_FromString(rlt_weight_kind_name(self->weight_kind));
+}
+
+static PyObject* rlt_roulette_iterator(PyRoulette* self){
+
+    PyObject *args = NULL, *iter = NULL;
+    bool complete = false;
+
+    do{
+        if( !(args = Py_BuildValue("(O)", self)))
+            break;
+
+        if(!(iter = rlt_roulette_iterator_new(&RouletteIteratorType, NULL, NULL)))
+            break;
+
+        if(rlt_roulette_iterator_init((PyRouletteIterator*)iter, args, NULL) < 0)
+            break;
+
+        complete = true;
     }while(0);
 
-    if(!complete){
-        if(args){
-            Py_DECREF(args);
-            Py_DECREF(self);//because Py_BuildValue succeded, self ref count was increased
-        }
+    Py_XDECREF(args);
+
+    if(!complete && iter){
+        Py_DECREF(iter);
+        iter = NULL;
+    }
+
+    return iter;
+}
+
+static PyMethodDef rlt_roulette_methods[] = {
+    {"insert", (PyCFunction) rlt_roulette_insert, METH_VARARGS, "inserts a python element into the roulette"},
+    {"insert_list", (PyCFunction) rlt_roulette_insert_list, METH_VARARGS, "inserts a python sequence of elements into the roulette"},
+    {"roll", (PyCFunction) rlt_roulette_roll, METH_NOARGS, "randomly choses an element and returns it"},
+    {"roll_for", (PyCFunction) rlt_roulette_roll_for, METH_VARARGS, "roll_for(key), element assigned to an int, str or bytes key without any randomness, it stays while the roulette does not change"},
+    {"roll_for_many", (PyCFunction) rlt_roulette_roll_for_many, METH_VARARGS, "roll_for_many(keys), roll_for over a buffer of integers or an iterable of keys, returns a list"},
+    {"roll_many", (PyCFunction)(void(*)(void)) rlt_roulette_roll_many, METH_VARARGS | METH_KEYWORDS, "roll_many(n, threads=0), n independent draws spread over threads (0 for one per core) with the GIL released"},
+    {"resample", (PyCFunction)(void(*)(void)) rlt_roulette_resample, METH_VARARGS | METH_KEYWORDS, "resample(n, method='multinomial'), n draws in one sorted sweep, method is multinomial, systematic, stratified or residual"},
+    {"set_prefetch", (PyCFunction)(void(*)(void)) rlt_roulette_set_prefetch, METH_VARARGS | METH_KEYWORDS, "set_prefetch(depth, refill_threshold=0), keeps up to depth pre-drawn samples, the next batch is built a few draws per roll, depth 0 turns it off"},
+    {"roll_range", (PyCFunction) rlt_roulette_roll_range, METH_VARARGS, "randomly choses an element among the entries in [first, last) and returns it"},
+    {"roll_excluding", (PyCFunction) rlt_roulette_roll_excluding, METH_VARARGS, "randomly choses an element as if the given keys had no weight, without changing the roulette, finding each key is a linear scan so k keys cost O(k * n) comparisons"},
+    {"roll_excluding_indices", (PyCFunction) rlt_roulette_roll_excluding_indices, METH_VARARGS, "roll_excluding_indices(indices), roll_excluding over slot indices from index(), O(k log k + log n) for k indices"},
+    {"index", (PyCFunction) rlt_roulette_index, METH_VARARGS, "index(key), slot of key in weights() and bounds(), valid until the roulette changes, weights() and bounds() count as a change when lazily removed slots are left"},
+    {"remove", (PyCFunction) rlt_roulette_remove, METH_VARARGS, "removes a python element from roulette"},
+    {"update", (PyCFunction) rlt_roulette_update, METH_VARARGS, "updates element chance in roulette"},
+    {"scale_all", (PyCFunction) rlt_roulette_scale_all, METH_VARARGS, "multiplies every chance by factor in constant time"},
+    {"add", (PyCFunction) rlt_roulette_add, METH_VARARGS, "adds delta to the chance of an element, inserting it when missing"},
+    {"set_lazy_removal", (PyCFunction) rlt_roulette_set_lazy_removal, METH_VARARGS, "set_lazy_removal(compaction_ratio), remove leaves a tombstone reused by later inserts and storage is compacted once tombstones pass the ratio, 0 removes right away"},
+    {"set_skew_search", (PyCFunction) rlt_roulette_set_skew_search, METH_VARARGS, "set_skew_search(enable), searches through a tree balanced by weight, faster when a few elements hold most of the chance"},
+    {"compact", (PyCFunction) rlt_roulette_compact, METH_NOARGS, "drops every tombstone left by lazy removal in one pass"},
+    {"weights", (PyCFunction) rlt_roulette_weights, METH_NOARGS, "read-only memoryview over the element weights, the roulette cannot change while it is alive"},
+    {"bounds", (PyCFunction) rlt_roulette_bounds, METH_NOARGS, "read-only memoryview over the cumulative upper bound of every element, the roulette cannot change while it is alive"},
+    {NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+static PyGetSetDef rlt_roulette_getset[] = {
+    {"weight_type", (getter) rlt_roulette_get_weight_type, NULL, "weight representation chosen at construction: double, float, uint32 or uint64", NULL},
+    {NULL, NULL, NULL, NULL, NULL}  /* Sentinel */
+};
+
+PyTypeObject* rlt_init_roulette_type(bool init){
+    
+    if(init){
+        RouletteTypeMappingMethods.mp_length = (lenfunc) rlt_roulette_len;
+        RouletteTypeMappingMethods.mp_subscript = (binaryfunc)rlt_roulette_get_item;
+        RouletteTypeMappingMethods.mp_ass_subscript = (objobjargproc)rlt_roulette_set_item;
+
+        RouletteType.tp_name = "roulette.roulette";
+        RouletteType.tp_basicsize = sizeof(PyRoulette);
+        RouletteType.tp_itemsize = 0;
+        RouletteType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
+        RouletteType.tp_doc = "roulette object";
+        RouletteType.tp_new = rlt_roulette_new;
+        RouletteType.tp_init = (initproc)rlt_roulette_init;
+        RouletteType.tp_dealloc = (destructor) rlt_roulette_dealloc;
+        RouletteType.tp_iter = (getiterfunc)rlt_roulette_iterator;
+        RouletteType.tp_methods = rlt_roulette_methods;
+        RouletteType.tp_getset = rlt_roulette_getset;
+        RouletteType.tp_as_mapping = &RouletteTypeMappingMethods;
+    }
+
+    return &RouletteType;
+}
+
+/********************************************************** roulette type **********************************************************/
+
+/********************************************************** roulette iterator **********************************************************/
+
+static void rlt_roulette_iterator_dealloc(PyRouletteIterator *self){
+
+    Py_XDECREF(self->roulette);
+    Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+static PyObject* rlt_roulette_iterator_new(PyTypeObject *type, PyObject *args, PyObject *kwds){
+
+    PyRouletteIterator *self = NULL;
+
+    if(!(self = (PyRouletteIterator *) type->tp_alloc(type, 0)))
+        return NULL;
+
+    self->roulette = NULL;
+    self->index = 0;
+
+    return (PyObject *)self;
+}
+
+static int rlt_roulette_iterator_init(PyRouletteIterator *self, PyObject *args, PyObject *kwds){
+    static char roulette_str[] = "roulette";
+    static char *kwlist[] = {roulette_str, NULL};
+    PyObject* py_roulette = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|", kwlist, &py_roulette))
+        return -1;
+
+    if(!PyObject_TypeCheck(py_roulette, &RouletteType)){
+        PyErr_Format(PyExc_TypeError, "expecting object of type roulette");
+        return -1;
+    }
+
+    Py_INCREF(py_roulette);
+    Py_XSETREF(self->roulette, (PyRoulette*)py_roulette);
+    self->index = 0;
+
+    return 0;
+}   
+
+static PyObject* rlt_roulette_iterator_next (PyRouletteIterator * self){
+
+    if(!self->roulette){
+        PyErr_Format(PyExc_StopIteration, "");
+        return NULL;
+    }
+
+    return rlt_roulette_visit(self->roulette, [&](auto* roulette) -> PyObject* {
+        PyObject* ret_val = NULL;
+
+        while((size_t)self->index < roulette->slot_count() && roulette->is_tombstone(self->index))
+            ++(self->index);
+
+        if((size_t)self->index >= roulette->slot_count()){
+            PyErr_Format(PyExc_StopIteration, "");
+            return NULL;
+        }
+
+        if(!(ret_val = Py_BuildValue("(ON)", (PyObject*)roulette->at(self->index).get_value(), rlt_weight_to_py(roulette->get_weight(self->index))))){
+            return NULL;
+        }
+
+        ++(self->index);
+
+        return ret_val;
+    });
+}
+
+static PyMethodDef rlt_roulette_iterator_methods[] = {
+    {NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+PyTypeObject* rlt_init_roulette_iterator_type(bool init){
+    
+    if(init){
+        RouletteIteratorType.tp_name = "roulette.rlt_iter";
+        RouletteIteratorType.tp_basicsize = sizeof(PyRouletteIterator);
+        RouletteIteratorType.tp_itemsize = 0;
+        RouletteIteratorType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
+        RouletteIteratorType.tp_doc = "roulette iterator object";
+        RouletteIteratorType.tp_new = rlt_roulette_iterator_new;
+        RouletteIteratorType.tp_init = (initproc)rlt_roulette_iterator_init;
+        RouletteIteratorType.tp_dealloc = (destructor) rlt_roulette_iterator_dealloc;
+        RouletteIteratorType.tp_methods = rlt_roulette_iterator_methods;
+        RouletteIteratorType.tp_iter = PyObject_SelfIter;
+        RouletteIteratorType.tp_iternext = (iternextfunc)rlt_roulette_iterator_next;
+    }
+
+    return &RouletteIteratorType;
+}
+
+/********************************************************** roulette iterator **********************************************************/
+
+/********************************************************** roulette view **********************************************************/
+
+static void rlt_roulette_view_dealloc(PyRouletteView *self){
+
+    Py_XDECREF(self->roulette);
+    Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+/* exposes one field of the roulette storage as a strided read-only buffer, no copy is made */
+static int rlt_roulette_view_getbuffer(PyRouletteView *self, Py_buffer *view, int flags){
+
+    if(flags & PyBUF_WRITABLE){
+        PyErr_Format(PyExc_BufferError, "roulette views are read-only");
+        view->obj = NULL;
+        return -1;
+    }
+
+    if(!(flags & PyBUF_STRIDES) && rlt_roulette_len(self->roulette) > 1){
+        PyErr_Format(PyExc_BufferError, "roulette views are strided, request a strided buffer");
+        view->obj = NULL;
+        return -1;
+    }
+
+    //views show plain storage, rlt_roulette_view_create compacts it unless roll_many is reading the table meanwhile
+    if(rlt_roulette_visit(self->roulette, [](auto* roulette){ return roulette->tombstone_count(); })){
+        PyErr_Format(PyExc_BufferError, "cannot view a roulette holding tombstones while roll_many is running");
+        view->obj = NULL;
+        return -1;
+    }
+
+    rlt_roulette_visit(self->roulette, [&](auto* roulette){
+        typedef rlt_weight_t<decltype(roulette)> weight_t;
+        typedef typename std::remove_pointer<decltype(roulette)>::type::ranged_value ranged_value_t;
+        static weight_t empty_storage = 0;
+
+        auto const* storage = roulette->data();
+        weight_t const* field = &empty_storage;
+
+        if(storage)
+            field = (self->field == RLT_VIEW_WEIGHTS)? &storage->get_range() : &storage->get_max();
+
+        self->shape[0] = (Py_ssize_t)roulette->size();
+        self->strides[0] = sizeof(ranged_value_t);
+
+        view->buf = (void*)field;
+        view->itemsize = sizeof(weight_t);
+        view->len = self->shape[0] * view->itemsize;
+        view->format = (flags & PyBUF_FORMAT)? (char*)rlt_weight_format((weight_t*)NULL) : NULL;
+    });
+
+    view->obj = (PyObject*)self;
+    Py_INCREF(self);
+    view->readonly = 1;
+    view->ndim = 1;
+    view->shape = self->shape;
+    view->strides = (flags & PyBUF_STRIDES)? self->strides : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+
+    ++(self->roulette->exports);
+
+    return 0;
+}
+
+static void rlt_roulette_view_releasebuffer(PyRouletteView *self, Py_buffer *Py_UNUSED(view)){
+    --(self->roulette->exports);
+}
+
+static PyObject* rlt_roulette_view_create(PyRoulette* roulette, rlt_view_field field){
+
+    PyRouletteView* view_obj = NULL;
+    PyObject* memory_view = NULL;
+
+    /*
+        views expose the raw storage, fold a pending scale_all into it and drop tombstones first (no view is alive
+        when either is pending). roll_many workers read the table without the GIL, so it is left alone while they run
+    */
+    if(!roulette->exports){
+        rlt_roulette_visit(roulette, [](auto* handler){
+            handler->normalize();
+            handler->compact();
+        });
+    }
+
+    if(!(view_obj = (PyRouletteView*) RouletteViewType.tp_alloc(&RouletteViewType, 0)))
+        return NULL;
+
+    Py_INCREF(roulette);
+    view_obj->roulette = roulette;
+    view_obj->field = field;
+
+    memory_view = PyMemoryView_FromObject((PyObject*)view_obj);
+    Py_DECREF(view_obj);
+
+    return memory_view;
+}
+
+PyTypeObject* rlt_init_roulette_view_type(bool init){
+    
+    if(init){
+        RouletteViewBufferProcs.bf_getbuffer = (getbufferproc) rlt_roulette_view_getbuffer;
+        RouletteViewBufferProcs.bf_releasebuffer = (releasebufferproc) rlt_roulette_view_releasebuffer;
+
+        RouletteViewType.tp_name = "roulette.rlt_view";
+        RouletteViewType.tp_basicsize = sizeof(PyRouletteView);
+        RouletteViewType.tp_itemsize = 0;
+        RouletteViewType.tp_flags = Py_TPFLAGS_DEFAULT;
+        RouletteViewType.tp_doc = "exporter behind roulette weights()/bounds() memoryviews";
+        RouletteViewType.tp_dealloc = (destructor) rlt_roulette_view_dealloc;
+        RouletteViewType.tp_as_buffer = &RouletteViewBufferProcs;
+    }
+
+    return &RouletteViewType;
+}
+
+/********************************************************** roulette view **********************************************************/
+
+/********************************************************** roulette bank **********************************************************/
+
+static void rlt_roulette_bank_dealloc(PyRouletteBank *self)
+{
+    if(self->bank_handler){
+        self->bank_handler->~RouletteBank();
+        PyMem_RawFree(self->bank_handler);
+    }
+    Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+static PyObject* rlt_roulette_bank_new(PyTypeObject *type, PyObject *args, PyObject *kwds){
+
+    PyRouletteBank *self;
+
+    void* temp_ptr = PyMem_RawMalloc(sizeof(RouletteBank<PythonSmartPointer>));
+
+    if(!temp_ptr)
+        return PyErr_NoMemory();
+
+    if(!(self = (PyRouletteBank *) type->tp_alloc(type, 0))){
+        PyMem_RawFree(temp_ptr);
+        return NULL;
+    }
+    
+    self->bank_handler = new(temp_ptr) RouletteBank<PythonSmartPointer>();
+
+    return (PyObject *)self;
+}
+
+static int rlt_roulette_bank_init(PyRouletteBank *self, PyObject *args, PyObject *kwds){
+    static char rows_str[] = "rows";
+    static char *kwlist[] = {rows_str, NULL};
+    PyObject* rows = NULL, *iterator = NULL, *item = NULL, *row_obj = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O", kwlist, &rows))
+        return -1;
+
+    if(rows){
+
+        if(!(iterator = PyObject_GetIter(rows))){
+            return -1;
+        }
+
+        while ((item = PyIter_Next(iterator)))
+        {
+            PyObject* add_args = PyTuple_Pack(1, item);
+            Py_DECREF(item);
+
+            if(!add_args || !(row_obj = rlt_roulette_bank_add(self, add_args))) {
+                Py_XDECREF(add_args);
+                Py_DECREF(iterator);
+                return -1;
+            }
+
+            Py_DECREF(add_args);
+            Py_DECREF(row_obj);
+        }
+
+        Py_DECREF(iterator);
+    }
+
+    if (PyErr_Occurred())
+        return -1;
+            
+    return 0;
+}
+
+/* adds one distribution given as a sequence of (object, chance) tuples, returns its row */
+static PyObject * rlt_roulette_bank_add(PyRouletteBank *self, PyObject *args)
+{
+    PyObject* chance_list = NULL, *sequence = NULL, *item = NULL, *object = NULL;
+    std::vector<std::pair<PythonSmartPointer, double> > row;
+    double chance;
+    size_t row_index;
+
+    if(!PyArg_ParseTuple(args, "O", &chance_list)) {
+        return NULL;
+    }
+
+    if(!(sequence = PySequence_Fast(chance_list, "row must be a sequence of tuples of an object and float"))){
+        return NULL;
+    }
+
+    row.reserve(PySequence_Fast_GET_SIZE(sequence));
+
+    for(Py_ssize_t i = 0 ; i < PySequence_Fast_GET_SIZE(sequence) ; ++i){
+        item = PySequence_Fast_GET_ITEM(sequence, i);
+
+        if(!PyTuple_Check(item) || !PyArg_ParseTuple(item, "Od", &object, &chance)){
+            Py_DECREF(sequence);
+            if(!PyErr_Occurred() || PyErr_ExceptionMatches(PyExc_TypeError)){
+                PyErr_Clear();
+                PyErr_Format(PyExc_TypeError, "item not a tuple of an object and float");
+            }
+            return NULL;
+        }
+
+        row.push_back(std::make_pair(PythonSmartPointer(object), chance));
+    }
+
+    Py_DECREF(sequence);
+
+    try{
+        row_index = self->bank_handler->add_row(row.begin(), row.end());
+    }catch(const std::exception& exception){
+        rlt_set_exception(exception);
+        return NULL;
+    }
+
+    return PyLong_FromSize_t(row_index);
+}
+
+static bool rlt_roulette_bank_row_from_py(PyRouletteBank *self, PyObject* py_row, size_t* row){
+
+    Py_ssize_t temp = PyLong_AsSsize_t(py_row);
+
+    if(temp == -1 && PyErr_Occurred())
+        return false;
+
+    if(temp < 0 || (size_t)temp >= self->bank_handler->rows()){
+        PyErr_Format(PyExc_IndexError, "row out of range");
+        return false;
+    }
+
+    *row = (size_t)temp;
+    return true;
+}
+
+static PyObject * rlt_roulette_bank_roll(PyRouletteBank *self, PyObject *args)
+{
+    PyObject* py_row;
+    size_t row;
+
+    if(!PyArg_ParseTuple(args, "O", &py_row)) {
+        return NULL;
+    }
+
+    if(!rlt_roulette_bank_row_from_py(self, py_row, &row))
+        return NULL;
+
+    return self->bank_handler->roll(row).increase_ref();
+}
+
+/* draws once from every row in a sequence of rows, returns the list of drawn objects */
+static PyObject * rlt_roulette_bank_roll_rows(PyRouletteBank *self, PyObject *args)
+{
+    PyObject* py_rows = NULL, *sequence = NULL, *result = NULL;
+    std::vector<size_t> rows;
+
+    if(!PyArg_ParseTuple(args, "O", &py_rows)) {
+        return NULL;
+    }
+
+    if(!(sequence = PySequence_Fast(py_rows, "rows must be a sequence of row indices"))){
+        return NULL;
+    }
+
+    rows.resize(PySequence_Fast_GET_SIZE(sequence));
+
+    for(size_t i = 0 ; i < rows.size() ; ++i){
+        if(!rlt_roulette_bank_row_from_py(self, PySequence_Fast_GET_ITEM(sequence, i), &rows[i])){
+            Py_DECREF(sequence);
+            return NULL;
+        }
+    }
+
+    Py_DECREF(sequence);
+
+    self->bank_handler->roll_rows(rows.begin(), rows.end(), rows.begin());
+
+    if(!(result = PyList_New(rows.size())))
+        return NULL;
+
+    for(size_t i = 0 ; i < rows.size() ; ++i)
+        PyList_SET_ITEM(result, i, self->bank_handler->get_value(rows[i]).increase_ref());
+
+    return result;
+}
+
+static PyObject * rlt_roulette_bank_row(PyRouletteBank *self, PyObject *args)
+{
+    PyObject* py_row, *result = NULL, *entry = NULL;
+    size_t row, first;
+
+    if(!PyArg_ParseTuple(args, "O", &py_row)) {
+        return NULL;
+    }
+
+    if(!rlt_roulette_bank_row_from_py(self, py_row, &row))
+        return NULL;
+
+    if(!(result = PyList_New(self->bank_handler->row_size(row))))
+        return NULL;
+
+    for(size_t i = 0 ; i < self->bank_handler->row_size(row) ; ++i){
+        first = self->bank_handler->row_begin(row) + i;
+
+        if(!(entry = Py_BuildValue("(Od)", (PyObject*)self->bank_handler->get_value(first), self->bank_handler->get_range(first)))){
+            Py_DECREF(result);
+            return NULL;
+        }
+
+        PyList_SET_ITEM(result, i, entry);
+    }
+
+    return result;
+}
+
+static Py_ssize_t rlt_roulette_bank_len(PyRouletteBank *self){
+    return self->bank_handler->rows();
+}
+
+static PyMethodDef rlt_roulette_bank_methods[] = {
+    {"add", (PyCFunction) rlt_roulette_bank_add, METH_VARARGS, "appends a distribution given as a sequence of (object, chance) tuples, returns its row"},
+    {"roll", (PyCFunction) rlt_roulette_bank_roll, METH_VARARGS, "randomly choses an element of the given row and returns it"},
+    {"roll_rows", (PyCFunction) rlt_roulette_bank_roll_rows, METH_VARARGS, "draws once from every row in a sequence of rows, returns a list"},
+    {"row", (PyCFunction) rlt_roulette_bank_row, METH_VARARGS, "returns the (object, chance) tuples of a row"},
+    {NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+PyTypeObject* rlt_init_roulette_bank_type(bool init){
+    
+    if(init){
+        RouletteBankTypeMappingMethods.mp_length = (lenfunc) rlt_roulette_bank_len;
+
+        RouletteBankType.tp_name = "roulette.roulette_bank";
+        RouletteBankType.tp_basicsize = sizeof(PyRouletteBank);
+        RouletteBankType.tp_itemsize = 0;
+        RouletteBankType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
+        RouletteBankType.tp_doc = "many small weighted distributions packed in one columnar store";
+        RouletteBankType.tp_new = rlt_roulette_bank_new;
+        RouletteBankType.tp_init = (initproc)rlt_roulette_bank_init;
+        RouletteBankType.tp_dealloc = (destructor) rlt_roulette_bank_dealloc;
+        RouletteBankType.tp_methods = rlt_roulette_bank_methods;
+        RouletteBankType.tp_as_mapping = &RouletteBankTypeMappingMethods;
+    }
+
+    return &RouletteBankType;
+}
+
+/********************************************************** roulette bank **********************************************************/
+
+/********************************************************** roulette mixture **********************************************************/
+
+static void rlt_roulette_mixture_dealloc(PyRouletteMixture *self)
+{
+    if(self->mixture_handler){
+        for(PyRoulette* component : self->mixture_handler->components)
+            Py_DECREF(component);
+
+        self->mixture_handler->~rlt_mixture_state();
+        PyMem_RawFree(self->mixture_handler);
+    }
+    Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+static PyObject* rlt_roulette_mixture_new(PyTypeObject *type, PyObject *args, PyObject *kwds){
+
+    PyRouletteMixture *self;
+
+    void* temp_ptr = PyMem_RawMalloc(sizeof(rlt_mixture_state));
+
+    if(!temp_ptr)
+        return PyErr_NoMemory();
+
+    if(!(self = (PyRouletteMixture *) type->tp_alloc(type, 0))){
+        PyMem_RawFree(temp_ptr);
+        return NULL;
+    }
+    
+    self->mixture_handler = new(temp_ptr) rlt_mixture_state();
+
+    return (PyObject *)self;
+}
+
+static int rlt_roulette_mixture_init(PyRouletteMixture *self, PyObject *args, PyObject *kwds){
+    static char components_str[] = "components";
+    static char *kwlist[] = {components_str, NULL};
+    PyObject* components = NULL, *iterator = NULL, *item = NULL, *none_obj = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O", kwlist, &components))
+        return -1;
+
+    if(components){
+
+        if(!(iterator = PyObject_GetIter(components))){
+            return -1;
+        }
+
+        while ((item = PyIter_Next(iterator)))
+        {
+            if(!PyTuple_Check(item)){
+                PyErr_Format(PyExc_TypeError, "components must be (roulette, weight) tuples");
+                Py_DECREF(item);
+                Py_DECREF(iterator);
+                return -1;
+            }
+
+            none_obj = rlt_roulette_mixture_add(self, item);
+            Py_DECREF(item);
+
+            if(!none_obj) {
+                Py_DECREF(iterator);
+                return -1;
+            }
+
+            Py_DECREF(none_obj);
+        }
+
+        Py_DECREF(iterator);
+    }
+
+    if (PyErr_Occurred())
+        return -1;
+            
+    return 0;
+}
+
+/* add(roulette, weight), the roulette is referenced, not copied, so later changes to it are sampled right away */
+static PyObject * rlt_roulette_mixture_add(PyRouletteMixture *self, PyObject *args)
+{
+    PyObject* component;
+    double weight;
+    rlt_mixture_state* mixture = self->mixture_handler;
+
+    if(!PyArg_ParseTuple(args, "O!d", &RouletteType, &component, &weight)) {
+        return NULL;
+    }
+
+    if(!(weight > 0) || std::isinf(weight)){
+        PyErr_Format(PyExc_ValueError, "mixture weight must be a positive finite number");
+        return NULL;
+    }
+
+    try{
+        mixture->components.reserve(mixture->components.size() + 1);
+        mixture->weights.push_back(weight);
+        mixture->table.build(mixture->weights.begin(), mixture->weights.end());
+    }catch(const std::exception& exception){
+        if(mixture->weights.size() > mixture->components.size())
+            mixture->weights.pop_back();
+
+        rlt_set_exception(exception);
+        return NULL;
+    }
+
+    Py_INCREF(component);
+    mixture->components.push_back((PyRoulette*)component);
+
+    Py_RETURN_NONE;
+}
+
+static PyObject * rlt_roulette_mixture_roll(PyRouletteMixture *self, PyObject *Py_UNUSED(ignored))
+{
+    rlt_mixture_state* mixture = self->mixture_handler;
+
+    if(mixture->components.empty()){
+        PyErr_Format(PyExc_IndexError, "cannot roll an empty mixture");
+        return NULL;
+    }
+
+    return rlt_roulette_roll(mixture->components[mixture->table.draw(mixture->rand_gen)], NULL);
+}
+
+/* returns the (roulette, weight) tuples the mixture was built from */
+static PyObject * rlt_roulette_mixture_components(PyRouletteMixture *self, PyObject *Py_UNUSED(ignored))
+{
+    rlt_mixture_state* mixture = self->mixture_handler;
+    PyObject* result = NULL, *entry = NULL;
+
+    if(!(result = PyList_New(mixture->components.size())))
+        return NULL;
+
+    for(size_t i = 0 ; i < mixture->components.size() ; ++i){
+        if(!(entry = Py_BuildValue("(Od)", (PyObject*)mixture->components[i], mixture->weights[i]))){
+            Py_DECREF(result);
+            return NULL;
+        }
+
+        PyList_SET_ITEM(result, i, entry);
+    }
+
+    return result;
+}
+
+static Py_ssize_t rlt_roulette_mixture_len(PyRouletteMixture *self){
+    return self->mixture_handler->components.size();
+}
+
+static PyMethodDef rlt_roulette_mixture_methods[] = {
+    {"add", (PyCFunction) rlt_roulette_mixture_add, METH_VARARGS, "add(roulette, weight), adds a component, the roulette is referenced so its later changes are seen"},
+    {"roll", (PyCFunction) rlt_roulette_mixture_roll, METH_NOARGS, "picks a component by mixture weight in constant time, then rolls it"},
+    {"components", (PyCFunction) rlt_roulette_mixture_components, METH_NOARGS, "returns the (roulette, weight) tuples of the mixture"},
+    {NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+PyTypeObject* rlt_init_roulette_mixture_type(bool init){
+    
+    if(init){
+        RouletteMixtureTypeMappingMethods.mp_length = (lenfunc) rlt_roulette_mixture_len;
+
+        RouletteMixtureType.tp_name = "roulette.roulette_mixture";
+        RouletteMixtureType.tp_basicsize = sizeof(PyRouletteMixture);
+        RouletteMixtureType.tp_itemsize = 0;
+        RouletteMixtureType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
+        RouletteMixtureType.tp_doc = "weighted mixture of roulettes sampled without merging them";
+        RouletteMixtureType.tp_new = rlt_roulette_mixture_new;
+        RouletteMixtureType.tp_init = (initproc)rlt_roulette_mixture_init;
+        RouletteMixtureType.tp_dealloc = (destructor) rlt_roulette_mixture_dealloc;
+        RouletteMixtureType.tp_methods = rlt_roulette_mixture_methods;
+        RouletteMixtureType.tp_as_mapping = &RouletteMixtureTypeMappingMethods;
+    }
+
+    return &RouletteMixtureType;
+}
+
+/********************************************************** roulette mixture **********************************************************/
+
+/********************************************************** shared roulette **********************************************************/
 
-        if(kwds)
-            Py_DECREF(kwds);
+#ifdef ROULETTE_HAS_SHARED_MEMORY
 
-        if(iter)
-            Py_DECREF(iter);
+static void rlt_shared_roulette_dealloc(PySharedRoulette *self)
+{
+    if(self->shared_handler){
+        self->shared_handler->~SharedRoulette();
+        PyMem_RawFree(self->shared_handler);
     }
-
-    return iter;
+    Py_TYPE(self)->tp_free((PyObject *) self);
 }
 
-static PyMethodDef rlt_roulette_methods[] = {
-    {"insert", (PyCFunction) rlt_roulette_insert, METH_VARARGS, "inserts a python element into the roulette"},
-    {"insert_list", (PyCFunction) rlt_roulette_insert_list, METH_VARARGS, "inserts a python sequence of elements into the roulette"},
-    {"roll", (PyCFunction) rlt_roulette_roll, METH_NOARGS, "randomly choses an element and returns it"},
-    {"remove", (PyCFunction) rlt_roulette_remove, METH_VARARGS, "removes a python element from roulette"},
-    {"update", (PyCFunction) rlt_roulette_update, METH_VARARGS, "updates element chance in roulette"},
-    {NULL, NULL, 0, NULL}  /* Sentinel */
-};
+/* attaches read-only to a roulette published with publish_shared */
+static PyObject* rlt_shared_roulette_new(PyTypeObject *type, PyObject *args, PyObject *kwds){
+    static char name_str[] = "name";
+    static char *kwlist[] = {name_str, NULL};
+    const char* name = NULL;
 
-PyTypeObject* rlt_init_roulette_type(bool init){
-    
-    if(init){
-        RouletteTypeMappingMethods.mp_length = (lenfunc) rlt_roulette_len;
-        RouletteTypeMappingMethods.mp_subscript = (binaryfunc)rlt_roulette_get_item;
-        RouletteTypeMappingMethods.mp_ass_subscript = (objobjargproc)rlt_roulette_set_item;
+    PySharedRoulette *self;
 
-        RouletteType.tp_name = "roulette.roulette";
-        RouletteType.tp_basicsize = sizeof(PyRoulette);
-        RouletteType.tp_itemsize = 0;
-        RouletteType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
-        RouletteType.tp_doc = "roulette object";
-        RouletteType.tp_new = rlt_roulette_new;
-        RouletteType.tp_init = (initproc)rlt_roulette_init;
-        RouletteType.tp_dealloc = (destructor) rlt_roulette_dealloc;
-        RouletteType.tp_iter = (getiterfunc)rlt_roulette_iterator;
-        RouletteType.tp_methods = rlt_roulette_methods;
-        RouletteType.tp_as_mapping = &RouletteTypeMappingMethods;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s", kwlist, &name))
+        return NULL;
+
+    void* temp_ptr = PyMem_RawMalloc(sizeof(SharedRoulette<>));
+
+    if(!temp_ptr)
+        return PyErr_NoMemory();
+
+    try{
+        new(temp_ptr) SharedRoulette<>(name);
+    }catch(const std::exception& exception){
+        PyMem_RawFree(temp_ptr);
+        rlt_set_exception(exception);
+        return NULL;
     }
 
-    return &RouletteType;
+    if(!(self = (PySharedRoulette *) type->tp_alloc(type, 0))){
+        ((SharedRoulette<>*)temp_ptr)->~SharedRoulette();
+        PyMem_RawFree(temp_ptr);
+        return NULL;
+    }
+    
+    self->shared_handler = (SharedRoulette<>*)temp_ptr;
+
+    return (PyObject *)self;
 }
 
-/********************************************************** roulette type **********************************************************/
+static PyObject* rlt_shared_roulette_value(SharedRoulette<>* shared, size_t index){
+
+    size_t length;
+    const char* bytes;
+
+    switch(shared->kind()){
+        case SharedRoulette<>::INTEGER_VALUES:
+            return PyLong_FromLongLong(shared->integer_value(index));
+        case SharedRoulette<>::TEXT_VALUES:
+            bytes = shared->bytes_value(index, &length);
+            return PyUnicode_DecodeUTF8(bytes, length, NULL);
+        case SharedRoulette<>::BYTES_VALUES:
+        default:
+            bytes = shared->bytes_value(index, &length);
+            return PyBytes_FromStringAndSize(bytes, length);
+    }
+}
 
-/********************************************************** roulette iterator **********************************************************/
+static PyObject * rlt_shared_roulette_roll(PySharedRoulette *self, PyObject *Py_UNUSED(ignored))
+{
+    size_t index;
 
-static void rlt_roulette_iterator_dealloc(PyRouletteIterator *self){
+    try{
+        index = self->shared_handler->roll_index();
+    }catch(const std::exception& exception){
+        rlt_set_exception(exception);
+        return NULL;
+    }
 
-    self->begin_iterator->Roulette<PythonSmartPointer>::iterator::~iterator();
-    PyMem_RawFree(self->begin_iterator);
-    self->end_iterator->Roulette<PythonSmartPointer>::iterator::~iterator();
-    PyMem_RawFree(self->end_iterator);
-    Py_TYPE(self)->tp_free((PyObject *) self);
+    return rlt_shared_roulette_value(self->shared_handler, index);
 }
 
-static PyObject* rlt_roulette_iterator_new(PyTypeObject *type, PyObject *args, PyObject *kwds){
+static PyObject * rlt_shared_roulette_refresh(PySharedRoulette *self, PyObject *Py_UNUSED(ignored))
+{
+    bool changed;
 
-    PyRouletteIterator *self = NULL;
-    void* temp_begin = NULL, *temp_end = NULL;
-    bool complete = false;
-    do{
-        
-        if(!(temp_begin = PyMem_RawMalloc(sizeof(Roulette<PythonSmartPointer>::iterator))))
-            break;
+    try{
+        changed = self->shared_handler->refresh();
+    }catch(const std::exception& exception){
+        rlt_set_exception(exception);
+        return NULL;
+    }
 
-        if(!(temp_end = PyMem_RawMalloc(sizeof(Roulette<PythonSmartPointer>::iterator))))
-            break;
+    return PyBool_FromLong(changed);
+}
 
-        if(!(self = (PyRouletteIterator *) type->tp_alloc(type, 0)))
-            break;
-        
-        complete = true;
-        
-    }while (0);
+static PyObject* rlt_shared_roulette_get_generation(PySharedRoulette *self, void *Py_UNUSED(closure)){
+    return PyLong_FromUnsignedLongLong(self->shared_handler->generation());
+}
 
-    if (!complete)
-    {
-        if(temp_begin)PyMem_RawFree(temp_begin);
+static Py_ssize_t rlt_shared_roulette_len(PySharedRoulette *self){
+    return self->shared_handler->size();
+}
+
+/* (value, chance) of the entry at index in the attached generation */
+static PyObject* rlt_shared_roulette_get_item(PySharedRoulette *self, PyObject *key){
 
-        if(temp_end)PyMem_RawFree(temp_end);
+    Py_ssize_t index = PyLong_AsSsize_t(key);
 
-        if(self)Py_TYPE(self)->tp_free((PyObject *) self);
+    if(index == -1 && PyErr_Occurred())
+        return NULL;
 
+    if(index < 0 || (size_t)index >= self->shared_handler->size()){
+        PyErr_Format(PyExc_IndexError, "index out of range");
         return NULL;
     }
+
+    return Py_BuildValue("(Nd)", rlt_shared_roulette_value(self->shared_handler, index), self->shared_handler->get_weight(index));
+}
+
+static PyMethodDef rlt_shared_roulette_methods[] = {
+    {"roll", (PyCFunction) rlt_shared_roulette_roll, METH_NOARGS, "randomly choses an element of the latest published generation and returns it"},
+    {"refresh", (PyCFunction) rlt_shared_roulette_refresh, METH_NOARGS, "moves to the latest published generation, returns True when it changed"},
+    {NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+static PyGetSetDef rlt_shared_roulette_getset[] = {
+    {"generation", (getter) rlt_shared_roulette_get_generation, NULL, "generation currently attached", NULL},
+    {NULL, NULL, NULL, NULL, NULL}  /* Sentinel */
+};
+
+PyTypeObject* rlt_init_shared_roulette_type(bool init){
     
-    self->begin_iterator = new(temp_begin) Roulette<PythonSmartPointer>::iterator();
-    self->end_iterator = new(temp_end) Roulette<PythonSmartPointer>::iterator();
+    if(init){
+        SharedRouletteTypeMappingMethods.mp_length = (lenfunc) rlt_shared_roulette_len;
+        SharedRouletteTypeMappingMethods.mp_subscript = (binaryfunc) rlt_shared_roulette_get_item;
+
+        SharedRouletteType.tp_name = "roulette.shared_roulette";
+        SharedRouletteType.tp_basicsize = sizeof(PySharedRoulette);
+        SharedRouletteType.tp_itemsize = 0;
+        SharedRouletteType.tp_flags = Py_TPFLAGS_DEFAULT;
+        SharedRouletteType.tp_doc = "read-only roulette attached from posix shared memory, shared_roulette(name)";
+        SharedRouletteType.tp_new = rlt_shared_roulette_new;
+        SharedRouletteType.tp_dealloc = (destructor) rlt_shared_roulette_dealloc;
+        SharedRouletteType.tp_methods = rlt_shared_roulette_methods;
+        SharedRouletteType.tp_getset = rlt_shared_roulette_getset;
+        SharedRouletteType.tp_as_mapping = &SharedRouletteTypeMappingMethods;
+    }
 
-    return (PyObject *)self;
+    return &SharedRouletteType;
 }
 
-static int rlt_roulette_iterator_init(PyRouletteIterator *self, PyObject *args, PyObject *kwds){
-    static char roulette_str[] = "roulette";
-    static char *kwlist[] = {roulette_str, NULL};
-    PyObject* py_roulette = NULL;
+/* publishes a sequence of (value, chance) tuples, values must all be int, all bytes or all str */
+static PyObject* rlt_publish_shared(PyObject *self, PyObject *args){
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|", kwlist, &py_roulette))
-        return -1;
+    const char* name = NULL;
+    PyObject* chance_list = NULL, *sequence = NULL, *item = NULL, *object = NULL;
+    std::vector<int64_t> integers;
+    std::vector<std::string> strings;
+    std::vector<double> weights;
+    int kind = -1, item_kind;
+    double chance;
 
-    if(!PyObject_TypeCheck(py_roulette, &RouletteType)){
-        PyErr_Format(PyExc_TypeError, "expecting object of type roulette");
-        return -1;
+    if(!PyArg_ParseTuple(args, "sO", &name, &chance_list)) {
+        return NULL;
     }
 
-    *(self->begin_iterator) = ((PyRoulette*)py_roulette)->roulette_handler->begin();
-    *(self->end_iterator) = ((PyRoulette*)py_roulette)->roulette_handler->end();
+    if(!(sequence = PySequence_Fast(chance_list, "chance_list must be a sequence of tuples of a value and float"))){
+        return NULL;
+    }
 
-    return 0;
-}   
+    for(Py_ssize_t i = 0 ; i < PySequence_Fast_GET_SIZE(sequence) ; ++i){
+        item = PySequence_Fast_GET_ITEM(sequence, i);
 
-static PyObject* rlt_roulette_iterator_next (PyRouletteIterator * self){
+        if(!PyTuple_Check(item) || !PyArg_ParseTuple(item, "Od", &object, &chance)){
+            Py_DECREF(sequence);
+            if(!PyErr_Occurred() || PyErr_ExceptionMatches(PyExc_TypeError)){
+                PyErr_Clear();
+                PyErr_Format(PyExc_TypeError, "item not a tuple of a value and float");
+            }
+            return NULL;
+        }
 
-    PyObject* ret_val = NULL;
+        item_kind = PyLong_Check(object)? SharedRoulette<>::INTEGER_VALUES : PyBytes_Check(object)? SharedRoulette<>::BYTES_VALUES : PyUnicode_Check(object)? SharedRoulette<>::TEXT_VALUES : -1;
 
-    if(*(self->begin_iterator) == *(self->end_iterator)){
-        PyErr_Format(PyExc_StopIteration, "");
+        if(item_kind < 0 || (kind >= 0 && item_kind != kind)){
+            Py_DECREF(sequence);
+            PyErr_Format(PyExc_TypeError, "shared roulette values must be all int, all bytes or all str");
+            return NULL;
+        }
+
+        kind = item_kind;
+        weights.push_back(chance);
+
+        if(kind == SharedRoulette<>::INTEGER_VALUES){
+            long long value = PyLong_AsLongLong(object);
+
+            if(value == -1 && PyErr_Occurred()){
+                Py_DECREF(sequence);
+                return NULL;
+            }
+
+            integers.push_back(value);
+        }else{
+            Py_ssize_t length;
+            const char* bytes = (kind == SharedRoulette<>::BYTES_VALUES)? PyBytes_AsString(object) : PyUnicode_AsUTF8AndSize(object, &length);
+
+            if(!bytes){
+                Py_DECREF(sequence);
+                return NULL;
+            }
+
+            if(kind == SharedRoulette<>::BYTES_VALUES)
+                length = PyBytes_GET_SIZE(object);
+
+            strings.push_back(std::string(bytes, length));
+        }
+    }
+
+    Py_DECREF(sequence);
+
+    try{
+        if(kind == SharedRoulette<>::INTEGER_VALUES)
+            SharedRoulette<>::publish(name, integers, weights);
+        else
+            SharedRoulette<>::publish(name, strings, weights, (kind == SharedRoulette<>::TEXT_VALUES)? SharedRoulette<>::TEXT_VALUES : SharedRoulette<>::BYTES_VALUES);
+    }catch(const std::exception& exception){
+        rlt_set_exception(exception);
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject* rlt_unlink_shared(PyObject *self, PyObject *args){
+
+    const char* name = NULL;
+
+    if(!PyArg_ParseTuple(args, "s", &name)) {
         return NULL;
     }
 
-    if(!(ret_val = Py_BuildValue("(Od)",(PyObject*)(*(self->begin_iterator))->get_value(), (*(self->begin_iterator))->get_max() - (*(self->begin_iterator))->get_min()))){
+    try{
+        SharedRoulette<>::unlink(name);
+    }catch(const std::exception& exception){
+        rlt_set_exception(exception);
         return NULL;
     }
 
-    ++(*(self->begin_iterator));
-    //Py_INCREF((PyObject*)(*(self->begin_iterator))->get_value());
+    Py_RETURN_NONE;
+}
+
+#endif //ROULETTE_HAS_SHARED_MEMORY
 
+/********************************************************** shared roulette **********************************************************/
 
-    return ret_val;
+/********************************************************** c api **********************************************************/
 
+static int rlt_capi_check(PyObject* object){
+    return object && PyObject_TypeCheck(object, &RouletteType);
 }
 
-static PyMethodDef rlt_roulette_iterator_methods[] = {
-    {NULL, NULL, 0, NULL}  /* Sentinel */
-};
+static bool rlt_capi_expect_roulette(PyObject* object){
 
-PyTypeObject* rlt_init_roulette_iterator_type(bool init){
-    
-    if(init){
-        RouletteIteratorType.tp_name = "roulette.rlt_iter";
-        RouletteIteratorType.tp_basicsize = sizeof(PyRouletteIterator);
-        RouletteIteratorType.tp_itemsize = 0;
-        RouletteIteratorType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
-        RouletteIteratorType.tp_doc = "roulette iterator object";
-        RouletteIteratorType.tp_new = rlt_roulette_iterator_new;
-        RouletteIteratorType.tp_init = (initproc)rlt_roulette_iterator_init;
-        RouletteIteratorType.tp_dealloc = (destructor) rlt_roulette_iterator_dealloc;
-        RouletteIteratorType.tp_methods = rlt_roulette_iterator_methods;
-        RouletteIteratorType.tp_iternext = (iternextfunc)rlt_roulette_iterator_next;
+    if(!rlt_capi_check(object)){
+        PyErr_Format(PyExc_TypeError, "expecting object of type roulette");
+        return false;
     }
 
-    return &RouletteIteratorType;
+    return true;
 }
 
-/********************************************************** roulette iterator **********************************************************/
+static Py_ssize_t rlt_capi_size(PyObject* roulette){
+
+    if(!rlt_capi_expect_roulette(roulette))
+        return -1;
+
+    return rlt_roulette_len((PyRoulette*)roulette);
+}
+
+static int rlt_capi_weight_kind(PyObject* roulette){
+
+    if(!rlt_capi_expect_roulette(roulette))
+        return -1;
+
+    return ((PyRoulette*)roulette)->weight_kind;
+}
+
+static PyObject* rlt_capi_roll(PyObject* roulette){
+
+    if(!rlt_capi_expect_roulette(roulette))
+        return NULL;
+
+    return rlt_roulette_roll((PyRoulette*)roulette, NULL);
+}
+
+static Py_ssize_t rlt_capi_roll_into(PyObject* roulette, PyObject** out, Py_ssize_t n){
+
+    if(!rlt_capi_expect_roulette(roulette))
+        return -1;
+
+    return rlt_roulette_visit((PyRoulette*)roulette, [&](auto* handler) -> Py_ssize_t {
+        Py_ssize_t i = 0;
+
+        if(n > 0 && handler->is_empty()){
+            PyErr_Format(PyExc_IndexError, "cannot roll an empty roulette");
+            return -1;
+        }
+
+        try{
+            for(; i < n ; ++i)
+                out[i] = handler->at(handler->roll_index()).get_value().increase_ref();
+        }catch(const std::exception& exception){
+            while(i > 0)
+                Py_DECREF(out[--i]);
+
+            rlt_set_exception(exception);
+            return -1;
+        }
+
+        return n;
+    });
+}
+
+static Py_ssize_t rlt_capi_roll_indices(PyObject* roulette, Py_ssize_t* out, Py_ssize_t n){
+
+    return rlt_roulette_visit((PyRoulette*)roulette, [&](auto* handler) -> Py_ssize_t {
+
+        if(n > 0 && handler->is_empty())
+            return -1;
+
+        try{
+            for(Py_ssize_t i = 0 ; i < n ; ++i)
+                out[i] = (Py_ssize_t)handler->roll_index();
+        }catch(...){
+            return -1;
+        }
+
+        return n;
+    });
+}
+
+static PyObject* rlt_capi_value_at(PyObject* roulette, Py_ssize_t index){
+
+    if(!rlt_capi_expect_roulette(roulette))
+        return NULL;
+
+    return rlt_roulette_visit((PyRoulette*)roulette, [&](auto* handler) -> PyObject* {
+        if(index < 0 || (size_t)index >= handler->slot_count() || handler->is_tombstone(index)){
+            PyErr_Format(PyExc_IndexError, "index out of range");
+            return NULL;
+        }
+
+        return (PyObject*)handler->at(index).get_value();
+    });
+}
+
+static int rlt_capi_lookup(PyObject* roulette, PyObject* key, double* weight){
+
+    if(!rlt_capi_expect_roulette(roulette))
+        return -1;
+
+    PythonSmartPointer ptr(key);
+
+    return rlt_roulette_visit((PyRoulette*)roulette, [&](auto* handler) -> int {
+        size_t index = handler->index_of(ptr);
+
+        if(PyErr_Occurred())
+            return -1;
+
+        if(index == handler->slot_count())
+            return 0;
+
+        *weight = (double)handler->get_weight(index);
+        return 1;
+    });
+}
+
+static void* rlt_capi_handler(PyObject* roulette){
+
+    if(!rlt_capi_expect_roulette(roulette))
+        return NULL;
+
+    return ((PyRoulette*)roulette)->roulette_handler;
+}
+
+static Roulette_CAPI rlt_capi = {
+    ROULETTE_CAPI_VERSION,
+    sizeof(Roulette_CAPI),
+    &RouletteType,
+    rlt_capi_check,
+    rlt_capi_size,
+    rlt_capi_weight_kind,
+    rlt_capi_roll,
+    rlt_capi_roll_into,
+    rlt_capi_roll_indices,
+    rlt_capi_value_at,
+    rlt_capi_lookup,
+    rlt_capi_handler
+};
+
+/********************************************************** c api **********************************************************/
 
 /********************************************************** roulette module **********************************************************/
 
@@ -576,6 +2350,10 @@ static PyObject* rlt_random_range(PyObject *self, PyObject *args){
 static PyMethodDef roulette_methods[] = {
 
     {"random_range", (PyCFunction)rlt_random_range, METH_VARARGS, "returns value in passed range"},
+#ifdef ROULETTE_HAS_SHARED_MEMORY
+    {"publish_shared", (PyCFunction)rlt_publish_shared, METH_VARARGS, "publish_shared(name, chance_list), publishes a read-only roulette in shared memory or replaces the published one"},
+    {"unlink_shared", (PyCFunction)rlt_unlink_shared, METH_VARARGS, "unlink_shared(name), removes a published shared roulette"},
+#endif
     {NULL,NULL,0,NULL} /* Sentinel */
 
 };
@@ -591,6 +2369,10 @@ PyMODINIT_FUNC PyInit_roulette(void)
     PyObject *module = NULL;
     PyTypeObject* roullete_type = NULL;
     PyTypeObject* roulette_iterator_type = NULL;
+    PyTypeObject* roulette_bank_type = NULL;
+    PyTypeObject* roulette_mixture_type = NULL;
+    PyTypeObject* shared_roulette_type = NULL;
+    PyObject* capi_capsule = NULL;
 	
     roulette_module.m_name = "roulette";   /* name of module */
     roulette_module.m_doc = "wighted random chooser module"; /* module documentation, may be NULL */
@@ -607,6 +2389,24 @@ PyMODINIT_FUNC PyInit_roulette(void)
         if (PyType_Ready(rlt_init_roulette_iterator_type(true)) < 0)
             break;
 
+        //ready new type
+        if (PyType_Ready(rlt_init_roulette_view_type(true)) < 0)
+            break;
+
+        //ready new type
+        if (PyType_Ready(rlt_init_roulette_bank_type(true)) < 0)
+            break;
+
+        //ready new type
+        if (PyType_Ready(rlt_init_roulette_mixture_type(true)) < 0)
+            break;
+
+#ifdef ROULETTE_HAS_SHARED_MEMORY
+        //ready new type
+        if (PyType_Ready(rlt_init_shared_roulette_type(true)) < 0)
+            break;
+#endif
+
         //ready module
         if (!(module = PyModule_Create(&roulette_module)))
             break;
@@ -622,7 +2422,35 @@ PyMODINIT_FUNC PyInit_roulette(void)
 
         if (PyModule_AddObject(module, "rlt_iter", (PyObject *) roulette_iterator_type) < 0)
             break;
+
+        roulette_bank_type = rlt_init_roulette_bank_type(false);
+        Py_INCREF(roulette_bank_type);
+
+        if (PyModule_AddObject(module, "roulette_bank", (PyObject *) roulette_bank_type) < 0)
+            break;
+
+        roulette_mixture_type = rlt_init_roulette_mixture_type(false);
+        Py_INCREF(roulette_mixture_type);
+
+        if (PyModule_AddObject(module, "roulette_mixture", (PyObject *) roulette_mixture_type) < 0)
+            break;
+
+#ifdef ROULETTE_HAS_SHARED_MEMORY
+        shared_roulette_type = rlt_init_shared_roulette_type(false);
+        Py_INCREF(shared_roulette_type);
+
+        if (PyModule_AddObject(module, "shared_roulette", (PyObject *) shared_roulette_type) < 0)
+            break;
+#endif
         
+        if (!(capi_capsule = PyCapsule_New(&rlt_capi, ROULETTE_CAPSULE_NAME, NULL)))
+            break;
+
+        if (PyModule_AddObject(module, "_C_API", capi_capsule) < 0)
+            break;
+
+        capi_capsule = NULL; //reference stolen by the module
+
         complete = true;
 
     }while(0);
@@ -638,6 +2466,23 @@ PyMODINIT_FUNC PyInit_roulette(void)
             roulette_iterator_type = NULL;
         }
 
+        if(roulette_bank_type){
+            Py_DECREF(roulette_bank_type);
+            roulette_bank_type = NULL;
+        }
+
+        if(roulette_mixture_type){
+            Py_DECREF(roulette_mixture_type);
+            roulette_mixture_type = NULL;
+        }
+
+        if(shared_roulette_type){
+            Py_DECREF(shared_roulette_type);
+            shared_roulette_type = NULL;
+        }
+
+        Py_XDECREF(capi_capsule);
+
         if(module){
             Py_DECREF(module);
             module = NULL;
@@ -1,7 +1,9 @@
 #define ROULETTE_DEBUG_CPP
 #include "roulette.hpp"
+#include "shared_roulette.hpp"
 #include <iostream>
 #include <map>
+#include <memory>
 
 #define ATTEMPTS 10000
 
@@ -88,5 +90,260 @@ int main(int argc, char* argv[]){
         cout << "value \"" << val.first << "\" was found " << val.second << " times" << endl;
     }
 
+    cout << endl;
+
+    Roulette<test_val_t, NewRand, uint32_t> counted_roulette({{"three", 3}, {"one", 1}});
+    std::map<test_val_t, size_t> counted;
+
+    for (int i = 0 ; i < ATTEMPTS ; ++i)
+        ++counted[counted_roulette.roll()];
+
+    for( auto const& val : counted){
+        cout << "integer weighted value \"" << val.first << "\" was found " << val.second << " times" << endl;
+    }
+
+    cout << endl;
+
+    constexpr StaticRoulette<const char*, 3, uint32_t> static_roulette({{"common", 6}, {"rare", 3}, {"epic", 1}});
+    static_assert(static_roulette.get_total() == 10, "static roulette table is built at compile time");
+
+    NewRand static_roller;
+    std::map<test_val_t, size_t> static_counted;
+
+    for (int i = 0 ; i < ATTEMPTS ; ++i)
+        ++static_counted[static_roulette.roll(static_roller)];
+
+    for( auto const& val : static_counted){
+        cout << "static value \"" << val.first << "\" was found " << val.second << " times" << endl;
+    }
+
+    cout << endl;
+
+    RouletteBank<test_val_t> bank;
+    bank.add_row({{"first row common", 3}, {"first row rare", 1}});
+    bank.add_row({{"second row only", 1}});
+
+    for (size_t row = 0 ; row < bank.rows() ; ++row){
+        std::map<test_val_t, size_t> bank_counted;
+
+        for (int i = 0 ; i < ATTEMPTS ; ++i)
+            ++bank_counted[bank.roll(row)];
+
+        for( auto const& val : bank_counted){
+            cout << "bank row " << row << " value \"" << val.first << "\" was found " << val.second << " times" << endl;
+        }
+    }
+
+    cout << endl;
+
+    Roulette<test_val_t, NewRand> decayed_roulette({{"decayed common", 3}, {"decayed rare", 1}});
+    decayed_roulette.scale_all(0.1);
+    decayed_roulette.add("fresh", 1);
+
+    cout << "total after decaying by 0.1 and adding a fresh value is " << decayed_roulette.get_total() << endl;
+
+    std::map<test_val_t, size_t> decayed_counted;
+
+    for (int i = 0 ; i < ATTEMPTS ; ++i)
+        ++decayed_counted[decayed_roulette.roll()];
+
+    for( auto const& val : decayed_counted){
+        cout << "decayed value \"" << val.first << "\" was found " << val.second << " times" << endl;
+    }
+
+    cout << endl;
+
+    Roulette<test_val_t, NewRand, double, HugePageAllocator> huge_roulette;
+    huge_roulette.reserve(100000);
+
+    for (int i = 0 ; i < 100000 ; ++i)
+        huge_roulette.insert((i < 25000)? "huge first quarter" : "huge rest", 1);
+
+    //folding a scale into the bounds must drop the replicas built over the old ones
+    huge_roulette.replicate_per_node(true);
+    huge_roulette.scale_all(0.5);
+    huge_roulette.normalize();
+
+    cout << "bounds replicated on " << numa_node_count() << " numa nodes" << endl;
+
+    std::map<test_val_t, size_t> huge_counted;
+
+    for (int i = 0 ; i < ATTEMPTS ; ++i)
+        ++huge_counted[huge_roulette.roll()];
+
+    for( auto const& val : huge_counted){
+        cout << "huge page value \"" << val.first << "\" was found " << val.second << " times" << endl;
+    }
+
+    cout << endl;
+
+    Roulette<std::unique_ptr<std::string>> owned_roulette;
+    owned_roulette.reserve(2);
+    owned_roulette.emplace(3.0, new std::string("owned three"));
+    owned_roulette.insert(std::make_unique<std::string>("owned one"), 1.0);
+
+    std::map<test_val_t, size_t> owned_counted;
+
+    for (int i = 0 ; i < ATTEMPTS ; ++i)
+        ++owned_counted[*owned_roulette.roll()];
+
+    for( auto const& val : owned_counted){
+        cout << "move only value \"" << val.first << "\" was found " << val.second << " times" << endl;
+    }
+
+    cout << endl;
+
+    std::map<test_val_t, size_t> excluding_counted;
+    std::vector<size_t> excluded = {roulette.index_of("smell you later")};
+
+    for (int i = 0 ; i < ATTEMPTS ; ++i)
+        ++excluding_counted[roulette.roll_excluding(excluded)];
+
+    for( auto const& val : excluding_counted){
+        cout << "value \"" << val.first << "\" was found " << val.second << " times with \"smell you later\" excluded" << endl;
+    }
+
+    cout << endl;
+
+    const char* resample_names[] = {"multinomial", "systematic", "stratified", "residual"};
+    const resample_method resample_methods[] = {RESAMPLE_MULTINOMIAL, RESAMPLE_SYSTEMATIC, RESAMPLE_STRATIFIED, RESAMPLE_RESIDUAL};
+
+    for (int method = 0 ; method < 4 ; ++method){
+        std::vector<size_t> resampled;
+        std::map<test_val_t, size_t> resample_counted;
+
+        roulette.resample(ATTEMPTS, std::back_inserter(resampled), resample_methods[method]);
+
+        for (size_t index : resampled)
+            ++resample_counted[roulette.at(index).get_value()];
+
+        for( auto const& val : resample_counted){
+            cout << resample_names[method] << " resampled value \"" << val.first << "\" was found " << val.second << " times" << endl;
+        }
+    }
+
+    cout << endl;
+
+    Roulette<test_val_t, NewRand> lazy_roulette({{"lazy kept", 2}, {"lazy removed", 3}, {"lazy other", 1}});
+    lazy_roulette.set_lazy_removal(1.0);
+
+    for (int step = 0 ; step < 3 ; ++step){
+        std::map<test_val_t, size_t> lazy_counted;
+
+        if (step == 0){
+            lazy_roulette.remove("lazy removed");
+        }else if (step == 1){
+            lazy_roulette.insert("lazy reinserted", 2);
+        }else{
+            lazy_roulette.compact();
+        }
+
+        cout << lazy_roulette.size() << " values in " << lazy_roulette.slot_count() << " slots, " << lazy_roulette.tombstone_count() << " tombstones" << endl;
+
+        for (int i = 0 ; i < ATTEMPTS ; ++i)
+            ++lazy_counted[lazy_roulette.roll()];
+
+        for( auto const& val : lazy_counted){
+            cout << "lazy value \"" << val.first << "\" was found " << val.second << " times" << endl;
+        }
+
+        cout << endl;
+    }
+
+    Roulette<test_val_t, NewRand> prefetched_roulette({{"prefetched common", 3}, {"prefetched rare", 1}});
+    prefetched_roulette.set_prefetch(64, 16);
+
+    for (int step = 0 ; step < 3 ; ++step){
+        std::map<test_val_t, size_t> prefetched;
+
+        if (step == 1)
+            prefetched_roulette.insert("prefetched inserted", 4);
+        else if (step == 2)
+            prefetched_roulette.remove("prefetched common");
+
+        for (int i = 0 ; i < ATTEMPTS ; ++i)
+            ++prefetched[prefetched_roulette.roll()];
+
+        for( auto const& val : prefetched){
+            cout << "prefetched value \"" << val.first << "\" was found " << val.second << " times" << endl;
+        }
+
+        cout << endl;
+    }
+
+    Roulette<test_val_t, NewRand> experiment({{"control", 1}, {"variant a", 1}, {"variant b", 2}});
+    std::map<test_val_t, size_t> assigned;
+
+    //python_test.py builds the same table and prints the same assignments
+    for (const char* key : {"user 1", "user 2", "user 3", "user 4", "user 5"}){
+        test_val_t first = experiment.roll_for(key), again = experiment.roll_for(test_val_t(key));
+        cout << "key \"" << key << "\" is assigned \"" << first << "\"" << ((first == again)? "" : " but not on the second roll") << endl;
+    }
+
+    for (int user_id = 0 ; user_id < ATTEMPTS ; ++user_id)
+        ++assigned[experiment.roll_for(user_id)];
+
+    for( auto const& val : assigned){
+        cout << "keyed value \"" << val.first << "\" was assigned " << val.second << " times" << endl;
+    }
+
+    cout << endl;
+
+    Roulette<test_val_t, NewRand> global_roulette({{"global common", 3}, {"global rare", 1}});
+    Roulette<test_val_t, NewRand> tenant_roulette({{"tenant only", 1}});
+    RouletteMixture<Roulette<test_val_t, NewRand> > mixture({{&global_roulette, 0.7}, {&tenant_roulette, 0.3}});
+    std::map<test_val_t, size_t> mixed;
+
+    for (int i = 0 ; i < ATTEMPTS ; ++i)
+        ++mixed[mixture.roll()];
+
+    for( auto const& val : mixed){
+        cout << "mixed value \"" << val.first << "\" was found " << val.second << " times" << endl;
+    }
+
+    cout << endl;
+
+    const size_t parallel_threads = 4;
+    std::vector<size_t> parallel_indices(ATTEMPTS * 10);
+    std::map<test_val_t, size_t> parallel_counted;
+
+    global_roulette.roll_parallel(parallel_indices.size(), parallel_indices.data(), parallel_threads, global_roulette.draw_seed());
+
+    for (size_t index : parallel_indices)
+        ++parallel_counted[global_roulette.at(index).get_value()];
+
+    cout << "rolled " << parallel_indices.size() << " values on " << parallel_threads << " threads" << endl;
+
+    for( auto const& val : parallel_counted){
+        cout << "parallel value \"" << val.first << "\" was found " << val.second << " times" << endl;
+    }
+
+#ifdef ROULETTE_HAS_SHARED_MEMORY
+    cout << endl;
+
+    //attached tables would normally live in other processes, one is enough to see the generations change
+    SharedRoulette<>::publish("roulette_test", std::vector<std::string>{"shared first", "shared second"}, {3, 1});
+    SharedRoulette<> shared_roulette("roulette_test");
+
+    for (int generation = 1 ; generation <= 2 ; ++generation){
+        std::map<test_val_t, size_t> shared_counted;
+
+        if (generation == 2)
+            SharedRoulette<>::publish("roulette_test", std::vector<std::string>{"shared first", "shared republished"}, {1, 1});
+
+        for (int i = 0 ; i < ATTEMPTS ; ++i){
+            size_t length;
+            const char* value = shared_roulette.bytes_value(shared_roulette.roll_index(), &length);
+            ++shared_counted[test_val_t(value, length)];
+        }
+
+        for( auto const& val : shared_counted){
+            cout << "generation " << shared_roulette.generation() << " shared value \"" << val.first << "\" was found " << val.second << " times" << endl;
+        }
+    }
+
+    SharedRoulette<>::unlink("roulette_test");
+#endif
+
     return 0;
 }
\ No newline at end of file
@@ -1,10 +1,16 @@
 #run command: python setup.py build --compiler=mingw32
+import sys
 from distutils.core import setup, Extension
 
-roulette = Extension('roulette', sources=['roulette_module.cpp'])
+# shm_open lives in librt on older glibc, roll_many starts std::threads
+roulette = Extension('roulette', sources=['roulette_module.cpp']
+                     , libraries=(['rt'] if sys.platform.startswith('linux') else [])
+                     , extra_compile_args=([] if sys.platform == 'win32' else ['-pthread'])
+                     , extra_link_args=([] if sys.platform == 'win32' else ['-pthread']))
 
 setup(name='roulette'
       , version='1.0 beta'
       , description='roulette module'
       , author='mrharmtz'
+      , headers=['roulette_capi.h', 'python_smart_pointer.hpp', 'roulette.hpp']
       , ext_modules=[roulette])
@@ -0,0 +1,436 @@
+#ifndef __SHARED_ROULETTE_HPP__
+#define __SHARED_ROULETTE_HPP__
+
+#include "roulette.hpp"
+
+#include <string>
+#include <atomic>
+#include <cerrno>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ROULETTE_HAS_SHARED_MEMORY
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef ROULETTE_HAS_SHARED_MEMORY
+
+/*
+    a read-only roulette living in posix shared memory, one process publishes it and any number attach in O(1).
+
+    /name           control segment, holds the generation currently published
+    /name.<gen>     data segment: header, cumulative bounds, then the value table
+
+    publishing again writes a new data segment, bumps the generation and unlinks the old one,
+    attached processes keep their mapping and move to the new generation on their next roll.
+*/
+template<typename ROLLER = NewRand>
+class SharedRoulette{
+public:
+    enum value_kind{
+        INTEGER_VALUES = 0, //int64 per entry
+        BYTES_VALUES = 1,   //byte strings, offsets[count+1] followed by the blob
+        TEXT_VALUES = 2     //utf-8 strings, stored like BYTES_VALUES
+    };
+
+private:
+    static const uint64_t control_magic = 0x52554c4354524c31ULL; //"RULCTRL1"
+    static const uint64_t data_magic = 0x52554c4441544131ULL;    //"RULDATA1"
+
+    struct control_block{
+        uint64_t magic;
+        std::atomic<uint64_t> generation;
+    };
+
+    struct data_header{
+        uint64_t magic;
+        uint64_t generation;
+        uint64_t count;
+        uint64_t value_kind;
+        uint64_t blob_size;
+        double total;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "the generation counter must be lock free to live in shared memory");
+
+    ROLLER _rand_gen;
+    std::string _name;
+    control_block const* _control;
+    void const* _data;
+    size_t _data_size;
+
+    data_header const* header()const{
+        return (data_header const*)_data;
+    }
+
+    double const* bounds()const{
+        return (double const*)(header() + 1);
+    }
+
+    int64_t const* integers()const{
+        return (int64_t const*)(bounds() + header()->count);
+    }
+
+    uint64_t const* offsets()const{
+        return (uint64_t const*)(bounds() + header()->count);
+    }
+
+    char const* blob()const{
+        return (char const*)(offsets() + header()->count + 1);
+    }
+
+    static std::string segment_name(const std::string& name){
+        return (!name.empty() && name[0] == '/')? name : "/" + name;
+    }
+
+    static std::string data_name(const std::string& name, uint64_t generation){
+        return segment_name(name) + "." + std::to_string(generation);
+    }
+
+    static std::system_error shm_error(const char* what){
+        return std::system_error(errno, std::generic_category(), what);
+    }
+
+    /* maps a whole segment, returns NULL with errno set when it does not exist */
+    static void* map_segment(const std::string& name, bool writable, size_t* size){
+
+        int fd = shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+
+        if(fd < 0)
+            return NULL;
+
+        struct stat info;
+
+        if(fstat(fd, &info) < 0){
+            int saved = errno;
+            close(fd);
+            errno = saved;
+            return NULL;
+        }
+
+        void* mapping = mmap(NULL, (size_t)info.st_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        int saved = errno;
+        close(fd);
+        errno = saved;
+
+        if(mapping == MAP_FAILED)
+            return NULL;
+
+        *size = (size_t)info.st_size;
+        return mapping;
+    }
+
+    void unmap_data(){
+        if(_data)
+            munmap((void*)_data, _data_size);
+
+        _data = NULL;
+        _data_size = 0;
+    }
+
+    /*
+        true when the segment of size bytes holds everything its header promises, a truncated or foreign segment
+        would otherwise send every attached process reading past the mapping. value offsets are checked in O(n)
+    */
+    static bool is_valid_data(data_header const* data, size_t size, uint64_t generation){
+
+        if(size < sizeof(data_header) || data->magic != data_magic || data->generation != generation)
+            return false;
+
+        //every bound is checked against what is left so no product below can overflow
+        size_t left = size - sizeof(data_header);
+
+        if(data->count > left / sizeof(double))
+            return false;
+
+        left -= data->count * sizeof(double);
+
+        if(data->value_kind == INTEGER_VALUES)
+            return data->count <= left / sizeof(int64_t) && data->blob_size == 0;
+
+        if(data->value_kind != BYTES_VALUES && data->value_kind != TEXT_VALUES)
+            return false;
+
+        if(data->count >= left / sizeof(uint64_t) || data->blob_size > left - (data->count + 1) * sizeof(uint64_t))
+            return false;
+
+        uint64_t const* value_offsets = (uint64_t const*)((double const*)(data + 1) + data->count);
+
+        for(size_t i = 0 ; i < data->count ; ++i)
+            if(value_offsets[i] > value_offsets[i + 1])
+                return false;
+
+        return value_offsets[0] == 0 && value_offsets[data->count] <= data->blob_size;
+    }
+
+    /* maps the generation currently published, retrying if it is replaced while we open it */
+    void map_current(){
+
+        for(;;){
+            uint64_t generation = _control->generation.load(std::memory_order_acquire);
+            size_t size = 0;
+            void* mapping = map_segment(data_name(_name, generation), false, &size);
+
+            if(!mapping){
+                if(errno == ENOENT && _control->generation.load(std::memory_order_acquire) != generation)
+                    continue;
+
+                throw shm_error("cannot map shared roulette data");
+            }
+
+            if(!is_valid_data((data_header const*)mapping, size, generation)){
+                munmap(mapping, size);
+                throw std::runtime_error("shared roulette data segment is corrupt");
+            }
+
+            unmap_data();
+            _data = mapping;
+            _data_size = size;
+
+            return;
+        }
+    }
+
+    /* writes one generation, fill(destination) writes the value table right after the bounds */
+    template<typename FILL>
+    static void publish_segment(const std::string& name, size_t count, uint64_t kind, size_t values_size, uint64_t blob_size, std::vector<double> const& weights, FILL fill){
+
+        if(weights.size() != count)
+            throw std::invalid_argument("values and weights must have the same length");
+
+        if(!count)
+            throw std::invalid_argument("a shared roulette needs at least one value");
+
+        double total = 0;
+
+        for(double weight : weights){
+            if(!(weight > 0))
+                throw std::invalid_argument("chance cannot be equal or less than 0");
+
+            total += weight;
+        }
+
+        //control segment, created on the first publish
+        int control_fd = shm_open(segment_name(name).c_str(), O_RDWR | O_CREAT, 0644);
+
+        if(control_fd < 0)
+            throw shm_error("cannot open shared roulette control segment");
+
+        if(ftruncate(control_fd, sizeof(control_block)) < 0){
+            int saved = errno;
+            close(control_fd);
+            errno = saved;
+            throw shm_error("cannot size shared roulette control segment");
+        }
+
+        control_block* control = (control_block*)mmap(NULL, sizeof(control_block), PROT_READ | PROT_WRITE, MAP_SHARED, control_fd, 0);
+        close(control_fd);
+
+        if(control == MAP_FAILED)
+            throw shm_error("cannot map shared roulette control segment");
+
+        uint64_t previous = (control->magic == control_magic)? control->generation.load(std::memory_order_acquire) : 0;
+        uint64_t generation = previous + 1;
+
+        size_t size = sizeof(data_header) + count * sizeof(double) + values_size + blob_size;
+        std::string data_segment = data_name(name, generation);
+        int data_fd = shm_open(data_segment.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+        if(data_fd < 0 || ftruncate(data_fd, size) < 0){
+            int saved = errno;
+            if(data_fd >= 0){
+                close(data_fd);
+                shm_unlink(data_segment.c_str());
+            }
+            munmap(control, sizeof(control_block));
+            errno = saved;
+            throw shm_error("cannot create shared roulette data segment");
+        }
+
+        void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, data_fd, 0);
+        close(data_fd);
+
+        if(mapping == MAP_FAILED){
+            int saved = errno;
+            shm_unlink(data_segment.c_str());
+            munmap(control, sizeof(control_block));
+            errno = saved;
+            throw shm_error("cannot map shared roulette data segment");
+        }
+
+        data_header* data = (data_header*)mapping;
+        double* data_bounds = (double*)(data + 1);
+        double running = 0;
+
+        data->magic = data_magic;
+        data->generation = generation;
+        data->count = count;
+        data->value_kind = kind;
+        data->blob_size = blob_size;
+        data->total = total;
+
+        for(size_t i = 0 ; i < count ; ++i)
+            data_bounds[i] = (running += weights[i]);
+
+        fill((char*)(data_bounds + count));
+        munmap(mapping, size);
+
+        //readers see the new generation only once it is complete
+        control->magic = control_magic;
+        control->generation.store(generation, std::memory_order_release);
+        munmap(control, sizeof(control_block));
+
+        if(previous)
+            shm_unlink(data_name(name, previous).c_str());
+    }
+
+public:
+
+    /* publishes a table of integer values, replacing any generation already published under name */
+    static void publish(const std::string& name, std::vector<int64_t> const& values, std::vector<double> const& weights){
+
+        publish_segment(name, values.size(), INTEGER_VALUES, values.size() * sizeof(int64_t), 0, weights, [&](char* destination){
+            if(!values.empty())
+                memcpy(destination, values.data(), values.size() * sizeof(int64_t));
+        });
+    }
+
+    /* publishes a table of byte string values, kind is BYTES_VALUES or TEXT_VALUES */
+    static void publish(const std::string& name, std::vector<std::string> const& values, std::vector<double> const& weights, value_kind kind = BYTES_VALUES){
+
+        uint64_t blob_size = 0;
+
+        for(auto const& value : values)
+            blob_size += value.size();
+
+        publish_segment(name, values.size(), kind, (values.size() + 1) * sizeof(uint64_t), blob_size, weights, [&](char* destination){
+            uint64_t* value_offsets = (uint64_t*)destination;
+            char* value_blob = (char*)(value_offsets + values.size() + 1);
+            uint64_t offset = 0;
+
+            for(size_t i = 0 ; i < values.size() ; ++i){
+                value_offsets[i] = offset;
+                memcpy(value_blob + offset, values[i].data(), values[i].size());
+                offset += values[i].size();
+            }
+
+            value_offsets[values.size()] = offset;
+        });
+    }
+
+    /* removes the published roulette, attached processes keep their current mapping */
+    static void unlink(const std::string& name){
+
+        size_t size = 0;
+        control_block* control = (control_block*)map_segment(segment_name(name), false, &size);
+
+        if(!control)
+            throw shm_error("cannot open shared roulette control segment");
+
+        uint64_t generation = control->generation.load(std::memory_order_acquire);
+        munmap(control, size);
+
+        shm_unlink(data_name(name, generation).c_str());
+        shm_unlink(segment_name(name).c_str());
+    }
+
+    /* attaches read-only to a published roulette */
+    SharedRoulette(const std::string& name, ROLLER rand_gen = ROLLER())
+    :_rand_gen(rand_gen)
+    ,_name(name)
+    ,_control(NULL)
+    ,_data(NULL)
+    ,_data_size(0)
+    {
+        size_t size = 0;
+
+        if(!(_control = (control_block const*)map_segment(segment_name(name), false, &size)))
+            throw shm_error("cannot open shared roulette control segment");
+
+        if(size < sizeof(control_block) || _control->magic != control_magic){
+            munmap((void*)_control, size);
+            throw std::runtime_error("not a shared roulette");
+        }
+
+        try{
+            map_current();
+        }catch(...){
+            munmap((void*)_control, sizeof(control_block));
+            throw;
+        }
+    }
+
+    SharedRoulette(const SharedRoulette&) = delete;
+    SharedRoulette& operator=(const SharedRoulette&) = delete;
+
+    ~SharedRoulette(){
+        unmap_data();
+
+        if(_control)
+            munmap((void*)_control, sizeof(control_block));
+    }
+
+    /* moves to the latest published generation, true when it changed */
+    bool refresh(){
+
+        if(_control->generation.load(std::memory_order_acquire) == header()->generation)
+            return false;
+
+        map_current();
+        return true;
+    }
+
+    uint64_t generation()const{
+        return header()->generation;
+    }
+
+    size_t size()const{
+        return header()->count;
+    }
+
+    value_kind kind()const{
+        return (value_kind)header()->value_kind;
+    }
+
+    double get_total()const{
+        return header()->total;
+    }
+
+    double get_weight(size_t index)const{
+        return index ? bounds()[index] - bounds()[index - 1] : bounds()[0];
+    }
+
+    int64_t integer_value(size_t index)const{
+        return integers()[index];
+    }
+
+    /* pointer into the shared blob, not null terminated */
+    char const* bytes_value(size_t index, size_t* length)const{
+        *length = offsets()[index + 1] - offsets()[index];
+        return blob() + offsets()[index];
+    }
+
+    /* draws an index from the latest generation */
+    size_t roll_index(){
+
+        refresh();
+
+        size_t count = size();
+
+        if(!count)
+            throw std::logic_error("cannot roll an empty roulette");
+
+        double const* first = bounds();
+        size_t index = std::upper_bound(first, first + count, _rand_gen(0.0, get_total())) - first;
+
+        return (index < count)? index : count - 1;
+    }
+};
+
+#endif //ROULETTE_HAS_SHARED_MEMORY
+
+#endif //__SHARED_ROULETTE_HPP__